@@ -0,0 +1,554 @@
+/* A websocket client using Boost.Beast
+ *
+ * (C) Copyright Ingo Randolf 2025.
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See
+ * accompanying file LICENSE or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ *
+ */
+
+#ifndef SCARYWS_BASIC_CLIENT_SESSION_H
+#define SCARYWS_BASIC_CLIENT_SESSION_H
+
+#include "ClientSessionBase.h"
+#include "GuardedStream.h"
+
+#include <memory>
+#include <string>
+
+#include <boost/beast/core.hpp>
+#include <boost/beast/websocket.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/url.hpp>
+
+#ifdef WSLIB_CLIENT_SESSION_VERBOSE
+#include <iostream>
+#endif
+
+namespace beast = boost::beast;
+namespace websocket = beast::websocket;
+namespace net = boost::asio;
+using tcp = boost::asio::ip::tcp;
+
+namespace scaryws
+{
+
+// a client session on a websocket stream over NextLayer
+// the sessions of the transports only differ in how the stream is
+// created and connected, the websocket handshake and everything after
+// it is done here
+template<class NextLayer>
+class BasicClientSession
+    : public ClientSessionBase
+    , public std::enable_shared_from_this<BasicClientSession<NextLayer>>
+{
+public:
+    explicit BasicClientSession(net::io_context& ioc);
+
+public:
+    // SessionBase
+    bool isConnected() const override;
+    void close() override;
+
+protected:
+    using Stream = websocket::stream<GuardedStream<NextLayer>>;
+
+    // a new, unconnected stream on m_strand
+    virtual Stream* newStream() = 0;
+
+    // connect m_socket, on the session strand
+    // calls handshake when the transport is connected
+    virtual void start() = 0;
+
+    // the websocket handshake
+    void handshake(const std::string& host, const std::string& target);
+
+protected:
+    void startSending() override;
+    void sendNext() override;
+    void writeChunk() override;
+    void reconnectAfter(std::chrono::milliseconds delay) override;
+
+protected:
+    void on_reconnect(beast::error_code ec);
+    void on_handshake(beast::error_code ec);
+    void do_read();
+    void on_read(beast::error_code ec, std::size_t bytes_transferred);
+    void on_close(beast::error_code ec);
+    void on_start();
+    void on_flush(beast::error_code ec);
+    void startPing();
+    void on_ping_timer(beast::error_code ec);
+    void on_ping(beast::error_code ec);
+
+protected:
+    // replaced for every reconnect
+    std::unique_ptr<Stream> m_socket;
+    std::unique_ptr<Stream> m_lostSocket;
+    net::steady_timer m_flushTimer;
+    net::steady_timer m_reconnectTimer;
+};
+
+// a client session connecting to the host of the url over tcp
+template<class NextLayer>
+class BasicTcpClientSession
+    : public BasicClientSession<NextLayer>
+{
+public:
+    explicit BasicTcpClientSession(net::io_context& ioc);
+
+protected:
+    // connect to the known or resolved endpoints
+    void start() override;
+
+    // the tcp connection is established, on the session strand
+    // default: the websocket handshake
+    virtual void connected(const tcp::endpoint& ep);
+
+    // path and query of the url
+    std::string target() const;
+
+private:
+    std::shared_ptr<BasicTcpClientSession> self();
+
+    void on_resolve(beast::error_code ec, tcp::resolver::results_type results);
+    void do_connect();
+    void on_connect(beast::error_code ec, tcp::endpoint ep);
+};
+
+
+template<class NextLayer>
+BasicClientSession<NextLayer>::BasicClientSession(net::io_context& ioc)
+    : ClientSessionBase(ioc)
+    , m_flushTimer(m_strand)
+    , m_reconnectTimer(m_strand)
+{
+}
+
+template<class NextLayer>
+void BasicClientSession<NextLayer>::startSending()
+{
+    // send may be called from any thread
+    // writing is done on the session strand
+    net::post(m_strand,
+              beast::bind_front_handler(&BasicClientSession::on_start,
+                                        this->shared_from_this()));
+}
+
+template<class NextLayer>
+void BasicClientSession<NextLayer>::on_start()
+{
+    // give a burst of messages time to arrive
+    if (m_coalescing.enabled &&
+        m_coalescing.flushDelay.count() > 0)
+    {
+        m_flushTimer.expires_after(m_coalescing.flushDelay);
+        m_flushTimer.async_wait(
+            beast::bind_front_handler(&BasicClientSession::on_flush,
+                                      this->shared_from_this()));
+        return;
+    }
+
+    sendNext();
+}
+
+template<class NextLayer>
+void BasicClientSession<NextLayer>::sendNext()
+{
+    // wait for the handshake
+    if (!m_open)
+    {
+        return;
+    }
+
+    const size_t count = nextMessages(m_socket->binary());
+
+    if (count == 0)
+    {
+        if (m_queue.stalled())
+        {
+            // a concurrent send is not finished, try again
+            // without spinning on the strand
+            m_flushTimer.expires_after(StalledRetryDelay);
+            m_flushTimer.async_wait(
+                beast::bind_front_handler(&BasicClientSession::on_flush,
+                                          this->shared_from_this()));
+        }
+    }
+    else if (m_batch.front().producer)
+    {
+        writeChunk();
+    }
+    else if (count == 1)
+    {
+        const OutgoingMessage& message = m_batch.front();
+        m_socket->compress(shouldCompress(message.compression, message.size(), m_compression));
+
+        m_socket->async_write(
+            message.payload.buffer(),
+            beast::bind_front_handler(&BasicClientSession::on_write,
+                                      this->shared_from_this()));
+    }
+    else if (count > 1)
+    {
+        // coalesced frames
+        m_socket->next_layer().async_write_raw(
+            net::buffer(m_frames),
+            beast::bind_front_handler(&BasicClientSession::on_write,
+                                      this->shared_from_this()));
+    }
+}
+
+template<class NextLayer>
+void BasicClientSession<NextLayer>::writeChunk()
+{
+    if (!nextChunk())
+    {
+        return close();
+    }
+
+    m_socket->compress(m_chunkCompress);
+
+    m_socket->async_write_some(
+        m_chunkLast,
+        m_chunk.buffer(),
+        beast::bind_front_handler(&BasicClientSession::on_write_chunk,
+                                  this->shared_from_this()));
+}
+
+template<class NextLayer>
+void BasicClientSession<NextLayer>::close()
+{
+    auto self(this->shared_from_this());
+    net::dispatch(m_strand, [self]
+    {
+        self->m_closing = true;
+        self->m_pingTimer.cancel();
+
+        if (!self->m_open)
+        {
+            // still connecting or waiting to reconnect
+            self->m_resolver.cancel();
+            self->m_reconnectTimer.cancel();
+            beast::get_lowest_layer(*self->m_socket).cancel();
+            return;
+        }
+
+        self->m_socket->async_close(
+            websocket::close_code::normal,
+            beast::bind_front_handler(&BasicClientSession::on_close,
+                                      self));
+    });
+}
+
+template<class NextLayer>
+bool BasicClientSession<NextLayer>::isConnected() const
+{
+    return m_connected.load(std::memory_order_acquire);
+}
+
+template<class NextLayer>
+void BasicClientSession<NextLayer>::reconnectAfter(std::chrono::milliseconds delay)
+{
+    // operations of the lost connection end with operation_aborted
+    beast::get_lowest_layer(*m_socket).close();
+
+    m_reconnectTimer.expires_after(delay);
+    m_reconnectTimer.async_wait(
+        beast::bind_front_handler(&BasicClientSession::on_reconnect,
+                                  this->shared_from_this()));
+}
+
+template<class NextLayer>
+void BasicClientSession<NextLayer>::on_reconnect(beast::error_code ec)
+{
+    if (ec ||
+        m_closing)
+    {
+        return closed();
+    }
+
+    m_reconnecting = false;
+
+    // a stream can not be connected again
+    // the queue and the read buffer are kept
+    // the lost stream is kept until the next reconnect,
+    // its aborted operations may still be pending
+    m_lostSocket = std::move(m_socket);
+    m_socket.reset(newStream());
+    m_socket->binary(m_lostSocket->binary());
+
+    rewindQueue();
+    m_buffer.consume(m_buffer.size());
+    m_receiving = false;
+    m_collected = 0;
+
+    start();
+}
+
+template<class NextLayer>
+void BasicClientSession<NextLayer>::handshake(const std::string& host,
+                                              const std::string& target)
+{
+    // m_socket.set_option(websocket::stream_base::decorator(
+    //     [](websocket::request_type& req)
+    // {
+    //     req.set(http::field::user_agent,
+    //             string("rcp-test-client"));
+    // }));
+
+    m_socket->set_option(permessageDeflate(m_compression));
+    m_socket->read_message_max(m_readLimits.maxMessageSize);
+
+    if (m_ping.enabled)
+    {
+        m_socket->control_callback(
+            [this](websocket::frame_type kind, beast::string_view payload)
+        {
+            controlFrame(kind, payload);
+        });
+    }
+
+    m_socket->async_handshake(
+        m_response,
+        host,
+        target,
+        beast::bind_front_handler(&BasicClientSession::on_handshake,
+                                  this->shared_from_this()));
+}
+
+template<class NextLayer>
+void BasicClientSession<NextLayer>::on_handshake(beast::error_code ec)
+{
+    if (ec)
+    {
+        return fail(ec, "handshake");
+    }
+
+    if (m_closing)
+    {
+        // closed after the handshake completed, not cancelled in time
+        return fail(net::error::operation_aborted, "handshake");
+    }
+
+    beast::get_lowest_layer(*m_socket).expires_never();
+    m_socket->next_layer().open();
+
+    m_deflate = negotiatedCompression(m_response);
+    opened();
+
+    do_read();
+    startPing();
+
+    // send data queued during the handshake
+    sendNext();
+}
+
+template<class NextLayer>
+void BasicClientSession<NextLayer>::do_read()
+{
+    const size_t size = nextReadSize();
+
+    // a chunk, or the first byte of the next message
+    if (size > 0)
+    {
+        m_socket->async_read_some(
+            m_buffer,
+            size,
+            beast::bind_front_handler(&BasicClientSession::on_read,
+                                      this->shared_from_this()));
+        return;
+    }
+
+    m_socket->async_read(
+        m_buffer,
+        beast::bind_front_handler(&BasicClientSession::on_read,
+                                  this->shared_from_this()));
+}
+
+template<class NextLayer>
+void BasicClientSession<NextLayer>::on_read(beast::error_code ec,
+                                            std::size_t bytes_transferred)
+{
+    boost::ignore_unused(bytes_transferred);
+
+    if (ec == websocket::error::closed ||
+        ec == boost::asio::error::operation_aborted)
+    {
+        return connectionLost(ec);
+    }
+
+    if (ec)
+    {
+        return fail(ec, "read");
+    }
+
+    readCompleted(m_socket->got_binary(), m_socket->is_message_done());
+
+    // read more
+    do_read();
+}
+
+template<class NextLayer>
+void BasicClientSession<NextLayer>::on_close(beast::error_code ec)
+{
+    if (ec)
+    {
+        return fail(ec, "close");
+    }
+
+    // If we get here then the connection is closed gracefully
+#ifdef WSLIB_CLIENT_SESSION_VERBOSE
+    auto reason = m_socket->reason();
+    std::cout << "closed (" << reason.code << "): " << reason.reason << std::endl;
+#endif
+}
+
+template<class NextLayer>
+void BasicClientSession<NextLayer>::startPing()
+{
+    if (!m_ping.enabled)
+    {
+        return;
+    }
+
+    m_pingTimer.expires_after(m_ping.interval);
+    m_pingTimer.async_wait(
+        beast::bind_front_handler(&BasicClientSession::on_ping_timer,
+                                  this->shared_from_this()));
+}
+
+template<class NextLayer>
+void BasicClientSession<NextLayer>::on_ping_timer(beast::error_code ec)
+{
+    if (ec ||
+        !m_open)
+    {
+        return;
+    }
+
+    m_socket->async_ping(
+        nextPing(),
+        beast::bind_front_handler(&BasicClientSession::on_ping,
+                                  this->shared_from_this()));
+}
+
+template<class NextLayer>
+void BasicClientSession<NextLayer>::on_ping(beast::error_code ec)
+{
+    // a failed connection is reported by the read
+    if (ec)
+    {
+        return;
+    }
+
+    startPing();
+}
+
+template<class NextLayer>
+void BasicClientSession<NextLayer>::on_flush(beast::error_code ec)
+{
+    if (ec)
+    {
+        return;
+    }
+
+    sendNext();
+}
+
+
+template<class NextLayer>
+BasicTcpClientSession<NextLayer>::BasicTcpClientSession(net::io_context& ioc)
+    : BasicClientSession<NextLayer>(ioc)
+{
+}
+
+template<class NextLayer>
+std::shared_ptr<BasicTcpClientSession<NextLayer>> BasicTcpClientSession<NextLayer>::self()
+{
+    return std::static_pointer_cast<BasicTcpClientSession>(this->shared_from_this());
+}
+
+template<class NextLayer>
+void BasicTcpClientSession<NextLayer>::start()
+{
+    // skip DNS if the endpoints are known
+    if (this->knownEndpoints())
+    {
+        return do_connect();
+    }
+
+    this->m_resolver.async_resolve(
+        this->m_url.host(),
+        this->m_url.port(),
+        beast::bind_front_handler(&BasicTcpClientSession::on_resolve,
+                                  self()));
+}
+
+template<class NextLayer>
+void BasicTcpClientSession<NextLayer>::on_resolve(beast::error_code ec,
+                                                  tcp::resolver::results_type results)
+{
+    if (ec)
+    {
+        return this->fail(ec, std::string("resolve: ") + this->m_url.host());
+    }
+
+    this->resolved(results);
+
+    do_connect();
+}
+
+template<class NextLayer>
+void BasicTcpClientSession<NextLayer>::do_connect()
+{
+    // Set a timeout on the operation
+    beast::get_lowest_layer(*this->m_socket).expires_after(std::chrono::seconds(30));
+
+    // Make the connection on the IP address we get from a lookup
+    beast::get_lowest_layer(*this->m_socket).async_connect(
+        this->m_connectEndpoints,
+        beast::bind_front_handler(&BasicTcpClientSession::on_connect,
+                                  self()));
+}
+
+template<class NextLayer>
+void BasicTcpClientSession<NextLayer>::on_connect(beast::error_code ec, tcp::endpoint ep)
+{
+    if (ec)
+    {
+        this->connectFailed();
+        return this->fail(ec, "connect");
+    }
+
+    // no delay
+    beast::get_lowest_layer(*this->m_socket).socket().set_option(tcp::no_delay(true));
+
+    // set timeout
+    beast::get_lowest_layer(*this->m_socket).expires_after(std::chrono::seconds(30));
+
+    connected(ep);
+}
+
+template<class NextLayer>
+void BasicTcpClientSession<NextLayer>::connected(const tcp::endpoint& ep)
+{
+    // Update the host_ string. This will provide the value of the
+    // Host HTTP header during the WebSocket handshake.
+    // See https://tools.ietf.org/html/rfc7230#section-5.4
+    this->handshake(this->m_url.host() + ":" + std::to_string(ep.port()), target());
+}
+
+template<class NextLayer>
+std::string BasicTcpClientSession<NextLayer>::target() const
+{
+    const boost::urls::url& url = this->m_url;
+
+    return (url.path().empty() ? "/" : url.path()) + (url.query().empty() ? "" : ("?" + url.query()));
+}
+
+} // namespace scaryws
+
+#endif // SCARYWS_BASIC_CLIENT_SESSION_H
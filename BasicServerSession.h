@@ -0,0 +1,414 @@
+/* A websocket server using Boost.Beast
+ *
+ * (C) Copyright Ingo Randolf 2025.
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See
+ * accompanying file LICENSE or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ *
+ */
+
+#ifndef SCARYWS_BASIC_SERVER_SESSION_H
+#define SCARYWS_BASIC_SERVER_SESSION_H
+
+#include "GuardedStream.h"
+#include "ServerSessionBase.h"
+
+#include <memory>
+#include <utility>
+
+#include <boost/beast/core.hpp>
+#include <boost/beast/websocket.hpp>
+#include <boost/asio/steady_timer.hpp>
+
+namespace beast = boost::beast;
+namespace http = beast::http;
+namespace websocket = beast::websocket;
+namespace net = boost::asio;
+
+namespace scaryws
+{
+
+// a server session on a websocket stream over NextLayer
+// the sessions of the transports only differ in how the stream is
+// created and in the handshake of the transport itself, e.g. TLS
+template<class NextLayer>
+class BasicServerSession
+    : public ServerSessionBase
+    , public std::enable_shared_from_this<BasicServerSession<NextLayer>>
+{
+public:
+    // args construct the next layer
+    template<class... Args>
+    explicit BasicServerSession(bool binary, Args&&... args);
+
+public:
+    // ServerSessionBase
+    void run(std::function<void(ServerSessionBase*)>&& cb) override;
+    void close() override;
+
+protected:
+    // the handshake of the transport, on the session strand
+    // calls readRequest when it completed
+    // default: none
+    virtual void handshake();
+    // read the http request of the websocket handshake
+    void readRequest();
+
+protected:
+    void startSending() override;
+    void sendNext() override;
+    void writeChunk() override;
+    void do_close() override;
+
+protected:
+    void on_start();
+    void on_run();
+    void on_request(beast::error_code ec, std::size_t bytes_transferred);
+    void on_accept(beast::error_code ec);
+    void do_read();
+    void on_read(beast::error_code ec, std::size_t bytes_transferred);
+    void on_flush(beast::error_code ec);
+    void startPing();
+    void on_ping_timer(beast::error_code ec);
+    void on_ping(beast::error_code ec);
+
+protected:
+    websocket::stream<GuardedStream<NextLayer>> m_socket;
+    net::steady_timer m_flushTimer;
+    net::steady_timer m_pingTimer;
+};
+
+
+template<class NextLayer>
+template<class... Args>
+BasicServerSession<NextLayer>::BasicServerSession(bool binary, Args&&... args)
+    : m_socket(std::forward<Args>(args)...)
+    , m_flushTimer(m_socket.get_executor())
+    , m_pingTimer(m_socket.get_executor())
+{
+    m_socket.binary(binary);
+}
+
+template<class NextLayer>
+void BasicServerSession<NextLayer>::startSending()
+{
+    // send may be called from any thread
+    // writing is done on the session strand
+    net::post(m_socket.get_executor(),
+              beast::bind_front_handler(&BasicServerSession::on_start,
+                                        this->shared_from_this()));
+}
+
+template<class NextLayer>
+void BasicServerSession<NextLayer>::on_start()
+{
+    // give a burst of messages time to arrive
+    if (m_coalescing.enabled &&
+        m_coalescing.flushDelay.count() > 0)
+    {
+        m_flushTimer.expires_after(m_coalescing.flushDelay);
+        m_flushTimer.async_wait(
+            beast::bind_front_handler(&BasicServerSession::on_flush,
+                                      this->shared_from_this()));
+        return;
+    }
+
+    sendNext();
+}
+
+template<class NextLayer>
+void BasicServerSession<NextLayer>::sendNext()
+{
+    // wait for the handshake
+    if (!m_open)
+    {
+        return;
+    }
+
+    if (nextMessages() == 0)
+    {
+        if (m_queue.stalled())
+        {
+            // a concurrent send is not finished, try again
+            // without spinning on the strand
+            m_flushTimer.expires_after(StalledRetryDelay);
+            m_flushTimer.async_wait(
+                beast::bind_front_handler(&BasicServerSession::on_flush,
+                                          this->shared_from_this()));
+        }
+        return;
+    }
+
+    if (m_batch.front().producer)
+    {
+        return writeChunk();
+    }
+
+    if (streamWrite())
+    {
+        m_socket.compress(compressNext());
+
+        m_socket.async_write(
+            m_batch.front().payload.buffer(),
+            beast::bind_front_handler(&BasicServerSession::on_write,
+                                      this->shared_from_this()));
+        return;
+    }
+
+    // pre-encoded or coalesced frames
+    prepareFrames(m_socket.binary());
+
+    m_socket.next_layer().async_write_raw(
+        m_buffers,
+        beast::bind_front_handler(&BasicServerSession::on_write,
+                                  this->shared_from_this()));
+}
+
+template<class NextLayer>
+void BasicServerSession<NextLayer>::writeChunk()
+{
+    if (!nextChunk())
+    {
+        return close();
+    }
+
+    m_socket.compress(m_chunkCompress);
+
+    m_socket.async_write_some(
+        m_chunkLast,
+        m_chunk.buffer(),
+        beast::bind_front_handler(&BasicServerSession::on_write_chunk,
+                                  this->shared_from_this()));
+}
+
+template<class NextLayer>
+void BasicServerSession<NextLayer>::close()
+{
+    auto self(this->shared_from_this());
+    net::dispatch(m_socket.get_executor(), [self]
+    {
+        // TODO: gracefully close this connection
+        // self->m_socket.close(boost::beast::websocket::normal);
+        beast::get_lowest_layer(self->m_socket).cancel();
+    });
+}
+
+// Get on the correct executor
+template<class NextLayer>
+void BasicServerSession<NextLayer>::run(std::function<void(ServerSessionBase*)>&& cb)
+{
+    m_closedCb = cb;
+
+    // We need to be executing within a strand to perform async operations
+    // on the I/O objects in this session. Although not strictly necessary
+    // for single-threaded contexts, this example code is written to be
+    // thread-safe by default.
+    net::dispatch(m_socket.get_executor(),
+                  beast::bind_front_handler(&BasicServerSession::on_run,
+                                            this->shared_from_this()));
+}
+
+// Start the asynchronous operation
+template<class NextLayer>
+void BasicServerSession<NextLayer>::on_run()
+{
+    // Set suggested timeout settings for the websocket
+    m_socket.set_option(
+        websocket::stream_base::timeout::suggested(
+            beast::role_type::server));
+
+    // Set a decorator to change the Server of the handshake
+    // m_socket.set_option(websocket::stream_base::decorator(
+    //     [](websocket::response_type& res)
+    // {
+    //     res.set(http::field::server,
+    //             std::string(BOOST_BEAST_VERSION_STRING) +
+    //                 " websocket-server-async");
+    // }));
+
+    m_socket.set_option(permessageDeflate(m_compression));
+    m_socket.read_message_max(m_readLimits.maxMessageSize);
+
+    if (m_ping.enabled)
+    {
+        m_socket.control_callback(
+            [this](websocket::frame_type kind, beast::string_view payload)
+        {
+            controlFrame(kind, payload);
+        });
+    }
+
+    handshake();
+}
+
+template<class NextLayer>
+void BasicServerSession<NextLayer>::handshake()
+{
+    readRequest();
+}
+
+template<class NextLayer>
+void BasicServerSession<NextLayer>::readRequest()
+{
+    // read the handshake request first
+    // to know the negotiated compression parameters
+    beast::get_lowest_layer(m_socket).expires_after(std::chrono::seconds(30));
+
+    http::async_read(
+        m_socket.next_layer(),
+        m_buffer,
+        m_request,
+        beast::bind_front_handler(&BasicServerSession::on_request,
+                                  this->shared_from_this()));
+}
+
+template<class NextLayer>
+void BasicServerSession<NextLayer>::on_request(beast::error_code ec,
+                                               std::size_t bytes_transferred)
+{
+    boost::ignore_unused(bytes_transferred);
+
+    if (ec)
+    {
+        return fail(ec, "request");
+    }
+
+    // the websocket stream uses its own timeouts
+    beast::get_lowest_layer(m_socket).expires_never();
+
+    requestReceived();
+
+    // Accept the websocket handshake
+    m_socket.async_accept(
+        m_request,
+        beast::bind_front_handler(&BasicServerSession::on_accept,
+                                  this->shared_from_this()));
+}
+
+template<class NextLayer>
+void BasicServerSession<NextLayer>::on_accept(beast::error_code ec)
+{
+    if (ec)
+    {
+        return fail(ec, "accept");
+    }
+
+    m_socket.next_layer().open();
+    accepted();
+
+    do_read();
+    startPing();
+
+    // send data queued during the handshake
+    sendNext();
+}
+
+template<class NextLayer>
+void BasicServerSession<NextLayer>::do_read()
+{
+    const size_t size = nextReadSize();
+
+    // a chunk, or the first byte of the next message
+    if (size > 0)
+    {
+        m_socket.async_read_some(
+            m_buffer,
+            size,
+            beast::bind_front_handler(&BasicServerSession::on_read,
+                                      this->shared_from_this()));
+        return;
+    }
+
+    m_socket.async_read(
+        m_buffer,
+        beast::bind_front_handler(&BasicServerSession::on_read,
+                                  this->shared_from_this()));
+}
+
+template<class NextLayer>
+void BasicServerSession<NextLayer>::on_read(beast::error_code ec,
+                                            std::size_t bytes_transferred)
+{
+    boost::ignore_unused(bytes_transferred);
+
+    if (ec == websocket::error::closed ||
+        ec == boost::asio::error::operation_aborted)
+    {
+        return closed(ec);
+    }
+
+    if (ec)
+    {
+        return fail(ec, "read");
+    }
+
+    readCompleted(m_socket.got_binary(), m_socket.is_message_done());
+
+    do_read();
+}
+
+template<class NextLayer>
+void BasicServerSession<NextLayer>::startPing()
+{
+    if (!m_ping.enabled)
+    {
+        return;
+    }
+
+    m_pingTimer.expires_after(m_ping.interval);
+    m_pingTimer.async_wait(
+        beast::bind_front_handler(&BasicServerSession::on_ping_timer,
+                                  this->shared_from_this()));
+}
+
+template<class NextLayer>
+void BasicServerSession<NextLayer>::on_ping_timer(beast::error_code ec)
+{
+    if (ec ||
+        m_ended)
+    {
+        return;
+    }
+
+    m_socket.async_ping(
+        nextPing(),
+        beast::bind_front_handler(&BasicServerSession::on_ping,
+                                  this->shared_from_this()));
+}
+
+template<class NextLayer>
+void BasicServerSession<NextLayer>::on_ping(beast::error_code ec)
+{
+    // a failed connection is reported by the read
+    if (ec)
+    {
+        return;
+    }
+
+    startPing();
+}
+
+template<class NextLayer>
+void BasicServerSession<NextLayer>::on_flush(beast::error_code ec)
+{
+    if (ec)
+    {
+        return;
+    }
+
+    sendNext();
+}
+
+template<class NextLayer>
+void BasicServerSession<NextLayer>::do_close()
+{
+    m_pingTimer.cancel();
+
+    beast::error_code ec;
+    beast::get_lowest_layer(m_socket).socket().shutdown(net::socket_base::shutdown_both, ec);
+}
+
+} // namespace scaryws
+
+#endif // SCARYWS_BASIC_SERVER_SESSION_H
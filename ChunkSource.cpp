@@ -0,0 +1,63 @@
+/* A websocket server and client using Boost.Beast
+ *
+ * (C) Copyright Ingo Randolf 2025.
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See
+ * accompanying file LICENSE or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ *
+ */
+
+#include "ChunkSource.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace scaryws
+{
+
+ChunkProducer chunksOf(const SharedBuffer& buffer, size_t chunkSize)
+{
+    chunkSize = std::max<size_t>(chunkSize, 1);
+    auto offset = std::make_shared<size_t>(0);
+
+    return [buffer, chunkSize, offset](SharedBuffer& chunk, bool& last)
+    {
+        const size_t size = std::min(chunkSize, buffer.size() - *offset);
+
+        // the chunks keep the payload alive
+        chunk = SharedBuffer(buffer.data() + *offset, size, [buffer]{});
+
+        *offset += size;
+        last = *offset == buffer.size();
+
+        return true;
+    };
+}
+
+ChunkProducer chunksOf(std::shared_ptr<std::istream> stream, size_t chunkSize)
+{
+    chunkSize = std::max<size_t>(chunkSize, 1);
+
+    return [stream, chunkSize](SharedBuffer& chunk, bool& last)
+    {
+        std::vector<char> data(chunkSize);
+
+        stream->read(data.data(), static_cast<std::streamsize>(data.size()));
+
+        if (stream->bad())
+        {
+            return false;
+        }
+
+        data.resize(static_cast<size_t>(stream->gcount()));
+
+        // a full chunk at the end is followed by an empty one
+        last = stream->eof();
+        chunk = SharedBuffer(std::move(data));
+
+        return true;
+    };
+}
+
+} // namespace scaryws
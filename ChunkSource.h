@@ -0,0 +1,39 @@
+/* A websocket server and client using Boost.Beast
+ *
+ * (C) Copyright Ingo Randolf 2025.
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See
+ * accompanying file LICENSE or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ *
+ */
+
+#ifndef SCARYWS_CHUNK_SOURCE_H
+#define SCARYWS_CHUNK_SOURCE_H
+
+#include <functional>
+#include <istream>
+#include <memory>
+
+#include "SharedBuffer.h"
+
+namespace scaryws
+{
+
+// produces the payload of a streamed message, one fragment at a time
+// called on the session strand whenever the previous chunk is written.
+// set last with the final chunk. return false to abort the message,
+// the connection is closed then: a started message can not be cancelled.
+using ChunkProducer = std::function<bool(SharedBuffer& chunk, bool& last)>;
+
+// stream a payload in fragments of chunkSize
+// the payload is not copied
+ChunkProducer chunksOf(const SharedBuffer& buffer, size_t chunkSize);
+
+// read chunkSize bytes at a time from stream until it ends
+// only one chunk is in memory at a time
+ChunkProducer chunksOf(std::shared_ptr<std::istream> stream, size_t chunkSize);
+
+} // namespace scaryws
+
+#endif // SCARYWS_CHUNK_SOURCE_H
@@ -0,0 +1,92 @@
+/* A websocket client using Boost.Beast
+ *
+ * (C) Copyright Ingo Randolf 2025.
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See
+ * accompanying file LICENSE or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ *
+ */
+
+#include "ClientEventLoop.h"
+
+#include <algorithm>
+#include <iostream>
+
+namespace scaryws
+{
+
+ClientEventLoop::ClientEventLoop(size_t threads)
+{
+    threads = std::max<size_t>(threads, 1);
+
+    m_contexts.reserve(threads);
+    m_work.reserve(threads);
+    m_threads.reserve(threads);
+
+    for (size_t i = 0; i < threads; i++)
+    {
+        // every context is run by one thread
+        m_contexts.emplace_back(new net::io_context(1));
+        m_work.push_back(net::make_work_guard(*m_contexts.back()));
+    }
+
+    for (auto& ioc : m_contexts)
+    {
+        m_threads.emplace_back(&ClientEventLoop::runContext, this, std::ref(*ioc));
+    }
+}
+
+ClientEventLoop::~ClientEventLoop()
+{
+    // operations of clients still running are abandoned
+    for (auto& work : m_work)
+    {
+        work.reset();
+    }
+
+    for (auto& ioc : m_contexts)
+    {
+        ioc->stop();
+    }
+
+    for (auto& thread : m_threads)
+    {
+        thread.join();
+    }
+}
+
+size_t ClientEventLoop::threads() const
+{
+    return m_contexts.size();
+}
+
+net::io_context& ClientEventLoop::next()
+{
+    const size_t index = m_next.fetch_add(1, std::memory_order_relaxed) % m_contexts.size();
+    return *m_contexts[index];
+}
+
+bool ClientEventLoop::runningInThisThread() const
+{
+    const std::thread::id id = std::this_thread::get_id();
+
+    return std::any_of(m_threads.begin(), m_threads.end(), [id](const std::thread& thread)
+    {
+        return thread.get_id() == id;
+    });
+}
+
+void ClientEventLoop::runContext(net::io_context& ioc)
+{
+    try
+    {
+        ioc.run();
+    }
+    catch(std::exception& ex)
+    {
+        std::cerr << "execption running ws-client event loop:" << ex.what() << "\n";
+    }
+}
+
+} // namespace scaryws
@@ -0,0 +1,63 @@
+/* A websocket client using Boost.Beast
+ *
+ * (C) Copyright Ingo Randolf 2025.
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See
+ * accompanying file LICENSE or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ *
+ */
+
+#ifndef SCARYWS_CLIENT_EVENT_LOOP_H
+#define SCARYWS_CLIENT_EVENT_LOOP_H
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <boost/asio/executor_work_guard.hpp>
+#include <boost/asio/io_context.hpp>
+
+namespace net = boost::asio;            // from <boost/asio.hpp>
+
+namespace scaryws
+{
+
+// io_contexts shared by many WebsocketClients
+//
+// every context is run by its own thread until the loop is destroyed.
+// clients connecting through the loop are spread over the contexts
+// round-robin, a client stays on its context for the whole connection.
+class ClientEventLoop
+{
+public:
+    explicit ClientEventLoop(size_t threads = 1);
+    ~ClientEventLoop();
+
+    ClientEventLoop(const ClientEventLoop&) = delete;
+    ClientEventLoop& operator=(const ClientEventLoop&) = delete;
+
+    size_t threads() const;
+
+    // the context for the next connection
+    net::io_context& next();
+
+    // true if called on one of the loop threads
+    bool runningInThisThread() const;
+
+private:
+    void runContext(net::io_context& ioc);
+
+private:
+    using WorkGuard = net::executor_work_guard<net::io_context::executor_type>;
+
+    std::vector<std::unique_ptr<net::io_context>> m_contexts;
+    std::vector<WorkGuard> m_work;
+    std::vector<std::thread> m_threads;
+    std::atomic<size_t> m_next{0};
+};
+
+} // namespace scaryws
+
+#endif // SCARYWS_CLIENT_EVENT_LOOP_H
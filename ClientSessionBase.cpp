@@ -10,6 +10,8 @@
 
 #include "ClientSessionBase.h"
 
+#include <algorithm>
+
 #ifdef WSLIB_CLIENT_SESSION_VERBOSE
 #include <iostream>
 #endif
@@ -18,7 +20,11 @@ namespace scaryws
 {
 
 ClientSessionBase::ClientSessionBase(net::io_context& ioc)
-    : m_resolver(net::make_strand(ioc))
+    : m_strand(net::make_strand(ioc))
+    , m_resolver(m_strand)
+    , m_pingTimer(m_strand)
+    , m_metrics(std::make_shared<Metrics>())
+    , m_jitterGenerator(std::random_device{}())
 {
 }
 
@@ -27,6 +33,146 @@ void ClientSessionBase::setListener(IClientSessionListener* listener)
     m_listener = listener;
 }
 
+void ClientSessionBase::sendQueueLimits(const SendQueueLimits& limits)
+{
+    m_queue.limits(limits);
+}
+
+void ClientSessionBase::writeCoalescing(const WriteCoalescing& coalescing)
+{
+    m_coalescing = coalescing;
+}
+
+void ClientSessionBase::moveReceived(bool move)
+{
+    m_moveReceived = move;
+}
+
+void ClientSessionBase::streamingReceive(const StreamingReceive& options)
+{
+    m_streamingReceive = options;
+}
+
+void ClientSessionBase::readLimits(const ReadLimits& limits)
+{
+    m_readLimits = limits;
+    m_buffer.limits(limits);
+}
+
+void ClientSessionBase::ping(const PingOptions& options)
+{
+    m_ping = options;
+}
+
+RoundTripTime ClientSessionBase::roundTripTime() const
+{
+    return m_rtt.get();
+}
+
+void ClientSessionBase::compression(const CompressionOptions& options)
+{
+    m_compression = options;
+}
+
+void ClientSessionBase::reconnect(const ReconnectOptions& options)
+{
+    m_reconnect = options;
+}
+
+void ClientSessionBase::resolveCache(std::shared_ptr<ResolveCache> cache)
+{
+    m_resolveCache = cache;
+}
+
+void ClientSessionBase::endpoints(const std::vector<tcp::endpoint>& endpoints)
+{
+    m_endpoints = endpoints;
+}
+
+void ClientSessionBase::metrics(std::shared_ptr<Metrics> metrics)
+{
+    m_metrics = metrics;
+}
+
+MetricsSnapshot ClientSessionBase::metrics() const
+{
+    MetricsSnapshot snapshot = m_metrics->snapshot();
+
+    snapshot.queuedMessages = m_queue.size();
+    snapshot.queuedBytes = m_queue.bytes();
+    snapshot.peakQueuedMessages = m_queue.peakSize();
+    snapshot.peakQueuedBytes = m_queue.peakBytes();
+
+    return snapshot;
+}
+
+void ClientSessionBase::closedCallback(std::function<void()>&& cb)
+{
+    m_closedCb = cb;
+}
+
+SendResult ClientSessionBase::send(const std::string& str, CompressionMode mode)
+{
+    return send(SharedBuffer(str), mode);
+}
+
+SendResult ClientSessionBase::send(const std::vector<char>& data, CompressionMode mode)
+{
+    return send(SharedBuffer(data), mode);
+}
+
+SendResult ClientSessionBase::send(std::string&& str, CompressionMode mode)
+{
+    return send(SharedBuffer(std::move(str)), mode);
+}
+
+SendResult ClientSessionBase::send(std::vector<char>&& data, CompressionMode mode)
+{
+    return send(SharedBuffer(std::move(data)), mode);
+}
+
+SendResult ClientSessionBase::send(const SharedBuffer& buffer, CompressionMode mode)
+{
+    OutgoingMessage message;
+    message.payload = buffer;
+    message.compression = mode;
+
+    bool start = false;
+    const SendResult result = m_queue.push(std::move(message), start);
+
+    if (result == SendResult::Disconnected)
+    {
+        close();
+    }
+    else if (start)
+    {
+        startSending();
+    }
+
+    return result;
+}
+
+SendResult ClientSessionBase::sendStream(ChunkProducer producer, CompressionMode mode)
+{
+    OutgoingMessage message;
+    message.compression = mode;
+    message.producer = std::make_shared<ChunkProducer>(std::move(producer));
+
+    bool start = false;
+    const SendResult result = m_queue.push(std::move(message), start);
+
+    if (result == SendResult::Disconnected)
+    {
+        close();
+    }
+    else if (start)
+    {
+        startSending();
+    }
+
+    return result;
+}
+
 void ClientSessionBase::on_write(beast::error_code ec, std::size_t bytes_transferred)
 {
     boost::ignore_unused(bytes_transferred);
@@ -39,15 +185,140 @@ void ClientSessionBase::on_write(beast::error_code ec, std::size_t bytes_transfe
 
     if (ec)
     {
-        fail(ec, "write");
+        // the messages stay queued for a reconnect
+        return fail(ec, "write");
+    }
+
+    const auto now = std::chrono::steady_clock::now();
+    const auto writeTime = std::chrono::duration_cast<std::chrono::microseconds>(now - m_writeStarted);
+    size_t bytes = 0;
+
+    for (auto& message : m_batch)
+    {
+        bytes += message.payload.size();
+        m_metrics->written(std::chrono::duration_cast<std::chrono::microseconds>(m_writeStarted - message.queued),
+                           writeTime);
+    }
+
+    m_metrics->sent(m_batch.size(), bytes);
+
+    // Remove the messages from the queue
+    if (m_queue.pop())
+    {
+        sendNext();
+    }
+}
+
+size_t ClientSessionBase::nextMessages(bool binary)
+{
+    // the messages stay in the queue until the write completed
+    // compressed messages are written one by one by the websocket stream
+    if (m_coalescing.enabled &&
+        !m_deflate.enabled)
+    {
+        if (m_queue.front(m_batch, m_coalescing.maxBytes) == 0)
+        {
+            return 0;
+        }
+    }
+    else
+    {
+        m_batch.resize(1);
+
+        if (!m_queue.front(m_batch.front()))
+        {
+            return 0;
+        }
+    }
+
+    m_writeStarted = std::chrono::steady_clock::now();
+
+    if (m_batch.size() > 1)
+    {
+        // client frames are masked, every payload is copied
+        m_frames.clear();
+
+        for (auto& message : m_batch)
+        {
+            // masking keys must not be predictable (RFC 6455 5.3),
+            // the generator websocket::stream uses for its own frames
+            const uint32_t maskKey = websocket::detail::secure_generate();
+            const FrameHeader header(binary, message.payload.size(), maskKey);
+            const char* headerData = static_cast<const char*>(header.buffer().data());
+
+            m_frames.insert(m_frames.end(), headerData, headerData + header.size());
+
+            const size_t offset = m_frames.size();
+            m_frames.insert(m_frames.end(),
+                            message.payload.data(),
+                            message.payload.data() + message.payload.size());
+
+            applyMask(m_frames.data() + offset, message.payload.size(), maskKey);
+        }
+    }
+
+    return m_batch.size();
+}
+
+void ClientSessionBase::on_write_chunk(beast::error_code ec, std::size_t bytes_transferred)
+{
+    // release the written chunk before producing the next one
+    m_chunk = SharedBuffer();
+
+    if (ec == websocket::error::closed ||
+        ec == boost::asio::error::operation_aborted)
+    {
+        // a reconnect drops the message in rewindQueue
+        return;
     }
 
-    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!ec)
+    {
+        m_metrics->sent(0, bytes_transferred);
+    }
 
-    // Remove the string from the queue
-    m_queue.erase(m_queue.begin());
+    if (ec ||
+        m_chunkLast)
+    {
+        m_streaming = false;
+        return on_write(ec, bytes_transferred);
+    }
 
-    sendNext();
+    writeChunk();
+}
+
+bool ClientSessionBase::nextChunk()
+{
+    const OutgoingMessage& message = m_batch.front();
+
+    m_chunk = SharedBuffer();
+    m_chunkLast = false;
+
+    if (!(*message.producer)(m_chunk, m_chunkLast))
+    {
+        return false;
+    }
+
+    if (!m_streaming)
+    {
+        // the first chunk decides if the message is compressed
+        m_streaming = true;
+        m_chunkCompress = shouldCompress(message.compression, m_chunk.size(), m_compression);
+    }
+
+    return true;
+}
+
+void ClientSessionBase::rewindQueue()
+{
+    if (m_streaming)
+    {
+        // the rest of the message can not be sent on a new connection
+        m_streaming = false;
+        m_queue.pop();
+    }
+
+    m_queue.rewind();
 }
 
 void ClientSessionBase::receivedData(beast::error_code ec,
@@ -56,13 +327,13 @@ void ClientSessionBase::receivedData(beast::error_code ec,
 {
     if (m_listener)
     {
-        if (binary)
+        if (m_moveReceived)
         {
-            m_listener->received(static_cast<const char*>(m_buffer.data().data()), m_buffer.data().size());
+            m_listener->receivedOwned(m_buffer.release(), binary);
         }
         else
         {
-            m_listener->received(std::string(static_cast<const char*>(m_buffer.data().data()), m_buffer.data().size()));
+            m_listener->receivedView(m_buffer.begin(), m_buffer.size(), binary);
         }
     }
     else
@@ -74,17 +345,153 @@ void ClientSessionBase::receivedData(beast::error_code ec,
     }
 
     // clear buffer
-    m_buffer.consume(m_buffer.size());
+    m_buffer.finish();
+}
+
+void ClientSessionBase::receivedChunk(bool binary, bool done)
+{
+    ChunkMarker marker = ChunkMarker::Continue;
+
+    if (!m_receiving)
+    {
+        marker = done ? ChunkMarker::Complete : ChunkMarker::Begin;
+    }
+    else if (done)
+    {
+        marker = ChunkMarker::Final;
+    }
+
+    m_receiving = !done;
+
+    // reads without payload, e.g. an empty frame, are not passed on
+    if (m_listener &&
+        (m_buffer.size() > 0 || marker != ChunkMarker::Continue))
+    {
+        const bool handled = m_listener->receivedChunk(m_buffer.begin(), m_buffer.size(), binary, marker);
+
+        // the listener takes whole messages, stop streaming
+        // the rest of this message is read into m_buffer
+        if (!handled &&
+            (marker == ChunkMarker::Begin || marker == ChunkMarker::Complete))
+        {
+            m_streamingReceive.enabled = false;
+            m_receiving = false;
+
+            if (done)
+            {
+                return receivedData(beast::error_code(), m_buffer.size(), binary);
+            }
+
+            m_collected = m_buffer.size();
+            return;
+        }
+    }
+
+    if (done)
+    {
+        m_buffer.finish();
+    }
+    else
+    {
+        m_buffer.consume(m_buffer.size());
+    }
+}
+
+size_t ClientSessionBase::nextReadSize()
+{
+    // wait for the next message without a buffer, read its first byte
+    m_waitingForMessage = m_readLimits.releaseIdle &&
+                          !m_receiving &&
+                          m_buffer.size() == 0;
+
+    if (m_waitingForMessage)
+    {
+        return 1;
+    }
+
+    if (m_streamingReceive.enabled)
+    {
+        return std::max<size_t>(m_streamingReceive.chunkSize, m_buffer.size() + 1) - m_buffer.size();
+    }
+
+    return 0;
+}
+
+void ClientSessionBase::readCompleted(bool binary, bool done)
+{
+    if (m_waitingForMessage &&
+        !done)
+    {
+        // the first byte is passed on with the rest of its chunk or message
+        return;
+    }
+
+    // the first chunk of a message collected after streaming stopped
+    // is already counted
+    m_metrics->received(m_buffer.size() - m_collected, done);
+    m_collected = 0;
+
+    if (m_streamingReceive.enabled)
+    {
+        return receivedChunk(binary, done);
+    }
+
+    receivedData(beast::error_code(), m_buffer.size(), binary);
+}
+
+websocket::ping_data ClientSessionBase::nextPing()
+{
+    std::chrono::microseconds pending(0);
+    websocket::ping_data payload = m_rtt.ping(pending);
+
+    // the last ping is still not answered
+    if (pending.count() > 0)
+    {
+        checkRoundTrip(pending);
+    }
+
+    return payload;
+}
+
+void ClientSessionBase::controlFrame(websocket::frame_type kind, beast::string_view payload)
+{
+    std::chrono::microseconds rtt(0);
+
+    if (kind == websocket::frame_type::pong &&
+        m_rtt.pong(payload, rtt))
+    {
+        checkRoundTrip(rtt);
+    }
+}
+
+void ClientSessionBase::checkRoundTrip(std::chrono::microseconds rtt)
+{
+    if (m_ping.threshold.count() > 0 &&
+        rtt > m_ping.threshold &&
+        m_listener)
+    {
+        m_listener->rttExceeded(rtt);
+    }
 }
 
 void ClientSessionBase::fail(beast::error_code ec, const std::string& what)
 {
+    if (m_connecting)
+    {
+        m_connecting = false;
+
+        if (!m_closing)
+        {
+            m_metrics->handshakeFailed(handshakeFailure(ec));
+        }
+    }
+
     // ignore some
     if (ec == websocket::error::closed ||
         ec == boost::asio::error::operation_aborted ||
         ec == boost::asio::error::misc_errors::eof)
     {
-        return;
+        return connectionLost(ec);
     }
 
 #ifdef WSLIB_CLIENT_SESSION_VERBOSE
@@ -95,6 +502,150 @@ void ClientSessionBase::fail(beast::error_code ec, const std::string& what)
     {
         m_listener->error(ec.value(), ec.message());
     }
+
+    // a failed operation ends the connection
+    connectionLost(ec);
+}
+
+void ClientSessionBase::opened()
+{
+    m_open = true;
+    m_connecting = false;
+    m_metrics->handshakeSucceeded();
+    m_reconnectAttempt = 0;
+    m_rtt.reset();
+    m_connected.store(true, std::memory_order_release);
+
+    if (m_listener)
+    {
+        m_listener->connected();
+    }
+}
+
+void ClientSessionBase::connectionLost(beast::error_code ec)
+{
+    if (m_reconnecting)
+    {
+        // another operation of the lost connection
+        return;
+    }
+
+    const bool wasOpen = m_open;
+
+    m_open = false;
+    m_pingTimer.cancel();
+
+    if (wasOpen)
+    {
+        m_metrics->disconnected(m_closing ? DisconnectReason::Local
+                                          : disconnectReason(ec));
+    }
+
+    if (m_closing ||
+        !m_reconnect.enabled ||
+        (m_reconnect.maxAttempts > 0 && m_reconnectAttempt >= m_reconnect.maxAttempts))
+    {
+        return closed();
+    }
+
+    m_reconnecting = true;
+    m_connecting = true;
+    m_connected.store(false, std::memory_order_release);
+
+    if (wasOpen &&
+        m_listener)
+    {
+        m_listener->disconnected(0);
+    }
+
+    reconnectAfter(reconnectDelay());
+}
+
+std::chrono::milliseconds ClientSessionBase::reconnectDelay()
+{
+    double delay = static_cast<double>(m_reconnect.initialDelay.count());
+
+    for (size_t i = 0; i < m_reconnectAttempt && delay < m_reconnect.maxDelay.count(); i++)
+    {
+        delay *= m_reconnect.multiplier;
+    }
+
+    delay = std::min(delay, static_cast<double>(m_reconnect.maxDelay.count()));
+
+    if (m_reconnect.jitter > 0)
+    {
+        // spread the reconnects of many clients
+        std::uniform_real_distribution<double> jitter(1.0 - m_reconnect.jitter, 1.0 + m_reconnect.jitter);
+        delay *= jitter(m_jitterGenerator);
+    }
+
+    m_reconnectAttempt++;
+
+    return std::chrono::milliseconds(static_cast<std::chrono::milliseconds::rep>(std::max(delay, 0.0)));
+}
+
+bool ClientSessionBase::knownEndpoints()
+{
+    m_cachedEndpoints = false;
+
+    if (!m_endpoints.empty())
+    {
+        m_connectEndpoints = m_endpoints;
+        return true;
+    }
+
+    // an expired entry is used while another session resolves the host
+    bool refresh = false;
+
+    if (m_resolveCache &&
+        m_resolveCache->find(m_url.host(), std::string(m_url.port()), m_connectEndpoints, refresh) &&
+        !refresh)
+    {
+        m_cachedEndpoints = true;
+        return true;
+    }
+
+    return false;
+}
+
+void ClientSessionBase::resolved(const tcp::resolver::results_type& results)
+{
+    m_connectEndpoints.clear();
+
+    for (const auto& entry : results)
+    {
+        m_connectEndpoints.push_back(entry.endpoint());
+    }
+
+    if (m_resolveCache)
+    {
+        m_resolveCache->store(m_url.host(), std::string(m_url.port()), m_connectEndpoints);
+    }
+}
+
+void ClientSessionBase::connectFailed()
+{
+    // the host may have moved, resolve it again
+    if (m_cachedEndpoints &&
+        m_resolveCache)
+    {
+        m_resolveCache->remove(m_url.host(), std::string(m_url.port()));
+    }
+}
+
+void ClientSessionBase::closed()
+{
+    m_connected.store(false, std::memory_order_release);
+
+    if (m_closed.exchange(true))
+    {
+        return;
+    }
+
+    if (m_closedCb)
+    {
+        m_closedCb();
+    }
 }
 
 } // namespace scaryws
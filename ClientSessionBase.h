@@ -13,11 +13,26 @@
 
 #include <boost/beast/core.hpp>
 #include <boost/beast/websocket.hpp>
+#include <boost/asio/steady_timer.hpp>
 #include <boost/asio/strand.hpp>
 #include <boost/asio/ip/tcp.hpp>
 #include <boost/url.hpp>
 
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <random>
+#include <vector>
+
+#include "Compression.h"
 #include "IClientSessionListener.h"
+#include "Metrics.h"
+#include "Ping.h"
+#include "ReadBuffer.h"
+#include "ResolveCache.h"
+#include "SendQueue.h"
+#include "SharedBuffer.h"
+#include "StreamingReceive.h"
 
 // #define WSLIB_CLIENT_SESSION_VERBOSE
 
@@ -29,38 +44,200 @@ using tcp = boost::asio::ip::tcp;
 namespace scaryws
 {
 
+// reconnect after the connection was lost or could not be established
+// the first attempt waits initialDelay, every failed attempt multiplies
+// the delay by multiplier, up to maxDelay. jitter randomizes every delay
+// by up to this fraction. maxAttempts 0 is unlimited.
+struct ReconnectOptions
+{
+    bool enabled{false};
+    std::chrono::milliseconds initialDelay{100};
+    std::chrono::milliseconds maxDelay{30000};
+    double multiplier{2.0};
+    double jitter{0.2};
+    size_t maxAttempts{0};
+};
+
 class ClientSessionBase
 {
 public:
     explicit ClientSessionBase(net::io_context& ioc);
 
     void setListener(IClientSessionListener* listener);
+    void sendQueueLimits(const SendQueueLimits& limits);
+    void writeCoalescing(const WriteCoalescing& coalescing);
+    // pass received messages to receivedOwned
+    void moveReceived(bool move);
+    // pass received messages in chunks to receivedChunk
+    void streamingReceive(const StreamingReceive& options);
+    void readLimits(const ReadLimits& limits);
+    void ping(const PingOptions& options);
+
+    // from any thread
+    RoundTripTime roundTripTime() const;
+    void compression(const CompressionOptions& options);
+    void reconnect(const ReconnectOptions& options);
+    void resolveCache(std::shared_ptr<ResolveCache> cache);
+    // connect to these endpoints instead of resolving the host of the url
+    void endpoints(const std::vector<tcp::endpoint>& endpoints);
+    // count into these metrics, e.g. to keep them over sessions
+    void metrics(std::shared_ptr<Metrics> metrics);
+    // counters and the send queue of this session, from any thread
+    MetricsSnapshot metrics() const;
+
+    // called once when the session ended, on the session strand
+    // set before run
+    void closedCallback(std::function<void()>&& cb);
+
+    SendResult send(const std::string& str, CompressionMode mode = CompressionMode::Auto);
+    SendResult send(const std::vector<char>& data, CompressionMode mode = CompressionMode::Auto);
+    SendResult send(std::string&& str, CompressionMode mode = CompressionMode::Auto);
+    SendResult send(std::vector<char>&& data, CompressionMode mode = CompressionMode::Auto);
+    SendResult send(const SharedBuffer& buffer, CompressionMode mode = CompressionMode::Auto);
+    // send a message in fragments produced by producer
+    SendResult sendStream(ChunkProducer producer, CompressionMode mode = CompressionMode::Auto);
 
 public:
+    // connect to url, from the thread running the io_context
+    virtual void run(const boost::urls::url& url) = 0;
     virtual bool isConnected() const = 0;
-    virtual void send(const std::string& str) = 0;
-    virtual void send(const std::vector<char>& data) = 0;
+    virtual void close() = 0;
 
 protected:
     void on_write(beast::error_code ec, std::size_t bytes_transferred);
+
+    // called from any thread when the queue needs its consumer
+    virtual void startSending() = 0;
+
+    // called on the session strand
     virtual void sendNext() = 0;
 
+    // close the lost connection and connect again after delay
+    // called on the session strand
+    virtual void reconnectAfter(std::chrono::milliseconds delay) = 0;
+
+    // take the messages for the next write from the queue
+    // returns the number of messages in m_batch
+    // more than one message are encoded as frames into m_frames
+    size_t nextMessages(bool binary);
+
+    // write m_chunk as the next fragment of the streamed message in m_batch
+    // called on the session strand
+    virtual void writeChunk() = 0;
+    void on_write_chunk(beast::error_code ec, std::size_t bytes_transferred);
+
+    // get the next chunk of the streamed message into m_chunk
+    // returns false if the producer aborted the message
+    bool nextChunk();
+
+    // the write of the queued messages did not complete
+    // a partly written streamed message is dropped
+    void rewindQueue();
+
 protected:
     void receivedData(beast::error_code ec,
                       std::size_t bytes_transferred,
                       bool binary);
+    // streaming receive: pass the chunk in m_buffer
+    // done if it ends the message
+    void receivedChunk(bool binary, bool done);
+
+    // bytes for the next read of the stream
+    // 0 reads the rest of the message
+    size_t nextReadSize();
+    // a read completed, done if it ends the message
+    void readCompleted(bool binary, bool done);
+
+    // the payload of the next ping
+    websocket::ping_data nextPing();
+    // set as control callback of the websocket stream
+    void controlFrame(websocket::frame_type kind, beast::string_view payload);
+    void checkRoundTrip(std::chrono::microseconds rtt);
 
     void fail(beast::error_code ec, const std::string& what);
 
+    // the websocket handshake completed
+    void opened();
+    // the connection is lost or could not be established
+    // reconnects or ends the session
+    void connectionLost(beast::error_code ec = beast::error_code());
+    void closed();
+
+    std::chrono::milliseconds reconnectDelay();
+
+    // put the pre-resolved or cached endpoints into m_connectEndpoints
+    // returns false if the host has to be resolved
+    bool knownEndpoints();
+    void resolved(const tcp::resolver::results_type& results);
+    // none of m_connectEndpoints could be connected
+    void connectFailed();
+
 protected:
     IClientSessionListener* m_listener{nullptr};
 
+    // all operations of the session run on this strand
+    net::strand<net::io_context::executor_type> m_strand;
     tcp::resolver m_resolver;
-    beast::flat_buffer m_buffer;
+    std::shared_ptr<ResolveCache> m_resolveCache;
+    std::vector<tcp::endpoint> m_endpoints;
+
+    // the endpoints of the current connection attempt
+    std::vector<tcp::endpoint> m_connectEndpoints;
+    bool m_cachedEndpoints{false};
+    ReadBuffer m_buffer;
+    bool m_moveReceived{false};
+    StreamingReceive m_streamingReceive;
+    // a message is being received in chunks
+    bool m_receiving{false};
+    // bytes in m_buffer already counted, when streaming stopped
+    // because the listener does not take chunks
+    size_t m_collected{0};
+    ReadLimits m_readLimits;
+    // reading the first byte of the next message
+    bool m_waitingForMessage{false};
+
+    PingOptions m_ping;
+    RttMeter m_rtt;
+    net::steady_timer m_pingTimer;
+
+    CompressionOptions m_compression;
+    websocket::response_type m_response;
+    NegotiatedCompression m_deflate;
     boost::urls::url m_url;
 
-    std::vector<std::shared_ptr<std::vector<char>>> m_queue;
-    std::mutex m_mutex;
+    SendQueue m_queue;
+    WriteCoalescing m_coalescing;
+
+    std::atomic<bool> m_connected{false};
+
+    // only accessed on the session strand
+    bool m_open{false};
+    bool m_closing{false};
+
+    std::shared_ptr<Metrics> m_metrics;
+    // a connection attempt is in progress
+    bool m_connecting{true};
+
+    ReconnectOptions m_reconnect;
+    bool m_reconnecting{false};
+    size_t m_reconnectAttempt{0};
+
+    std::vector<OutgoingMessage> m_batch;
+    // when the write of m_batch started
+    std::chrono::steady_clock::time_point m_writeStarted;
+    std::vector<char> m_frames;
+
+    // the streamed message being written
+    SharedBuffer m_chunk;
+    bool m_chunkLast{false};
+    bool m_chunkCompress{false};
+    bool m_streaming{false};
+
+    // reconnect jitter only, masking keys come from a secure generator
+    std::minstd_rand m_jitterGenerator;
+
+    std::function<void()> m_closedCb;
+    std::atomic<bool> m_closed{false};
 };
 
 } // namespace scaryws
@@ -11,59 +11,51 @@
 #ifndef SCARYWS_CLIENT_SSL_SESSION_H
 #define SCARYWS_CLIENT_SSL_SESSION_H
 
+#include <memory>
+#include <string>
+
 #include <boost/beast/core.hpp>
-#include <boost/beast/websocket.hpp>
 #include <boost/beast/websocket/ssl.hpp>
 #include <boost/asio/ssl.hpp>
-#include <boost/asio/strand.hpp>
-#include <boost/asio/local/stream_protocol.hpp>
+#include <boost/url.hpp>
 
-#include "ClientSessionBase.h"
+#include "BasicClientSession.h"
+#include "ClientTlsContext.h"
 
 namespace beast = boost::beast;         // from <boost/beast.hpp>
-namespace http = beast::http;           // from <boost/beast/http.hpp>
-namespace websocket = beast::websocket; // from <boost/beast/websocket.hpp>
 namespace net = boost::asio;            // from <boost/asio.hpp>
 namespace ssl = boost::asio::ssl;       // from <boost/asio/ssl.hpp>
 using tcp = boost::asio::ip::tcp;       // from <boost/asio/ip/tcp.hpp>
 
-using stream_protocol = net::local::stream_protocol;
-
 namespace scaryws
 {
 
+// instantiated in ClientSessionSSL.cpp
+extern template class BasicClientSession<ssl::stream<beast::tcp_stream>>;
+extern template class BasicTcpClientSession<ssl::stream<beast::tcp_stream>>;
+
 class ClientSessionSSL
-    : public ClientSessionBase
-    , public std::enable_shared_from_this<ClientSessionSSL>
+    : public BasicTcpClientSession<ssl::stream<beast::tcp_stream>>
 {
 public:
     // Resolver and socket require an io_context
-    explicit ClientSessionSSL(net::io_context& ioc, ssl::context& ctx, bool binary = true);
+    explicit ClientSessionSSL(net::io_context& ioc, std::shared_ptr<ClientTlsContext> tls, bool binary = true);
 
     // Start the asynchronous operation
-    void run(const boost::urls::url& url);
-
-    void close();
-
-public:
-    // SessionBase
-    bool isConnected() const override;
-    void send(const std::string& str) override;
-    void send(const std::vector<char>& data) override;
+    void run(const boost::urls::url& url) override;
 
 private:
-    void sendNext() override;
+    Stream* newStream() override;
+    void start() override;
+    void connected(const tcp::endpoint& ep) override;
 
 private:
-    void on_resolve(beast::error_code ec, tcp::resolver::results_type results);
-    void on_connect(beast::error_code ec, tcp::resolver::results_type::endpoint_type ep);
     void on_ssl_handshake(beast::error_code ec);
-    void on_handshake(beast::error_code ec);
-    void on_read(beast::error_code ec, std::size_t bytes_transferred);
-    void on_close(beast::error_code ec);
 
 private:
-    websocket::stream<ssl::stream<beast::tcp_stream>> m_socket;
+    std::shared_ptr<ClientTlsContext> m_tls;
+    // host:port, TLS sessions are cached under this key
+    std::string m_sessionKey;
 };
 
 } // namespace scaryws
@@ -0,0 +1,85 @@
+/* A websocket client using Boost.Beast
+ *
+ * (C) Copyright Ingo Randolf 2025.
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See
+ * accompanying file LICENSE or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ *
+ */
+
+#include "ClientSessionUnix.h"
+
+#ifdef BOOST_ASIO_HAS_LOCAL_SOCKETS
+
+namespace scaryws
+{
+
+template class BasicClientSession<beast::basic_stream<stream_protocol>>;
+
+ClientSessionUnix::ClientSessionUnix(net::io_context& ioc, bool binary)
+    : BasicClientSession(ioc)
+{
+    m_socket.reset(newStream());
+    m_socket->binary(binary);
+}
+
+ClientSessionUnix::Stream* ClientSessionUnix::newStream()
+{
+    return new Stream(m_strand);
+}
+
+void ClientSessionUnix::run(const boost::urls::url& url)
+{
+    m_url = url;
+
+    // the socket path ends at the first ':'
+    // the rest is the request target
+    const std::string path = m_url.path();
+    const size_t separator = path.find(':');
+
+    m_socketPath = path.substr(0, separator);
+    m_target = separator == std::string::npos ? "/" : path.substr(separator + 1);
+
+    if (m_target.empty())
+    {
+        m_target = "/";
+    }
+
+    if (!m_url.query().empty())
+    {
+        m_target += "?" + m_url.query();
+    }
+
+    start();
+}
+
+void ClientSessionUnix::start()
+{
+    // Set a timeout on the operation
+    beast::get_lowest_layer(*m_socket).expires_after(std::chrono::seconds(30));
+
+    beast::get_lowest_layer(*m_socket).async_connect(
+        stream_protocol::endpoint(m_socketPath),
+        beast::bind_front_handler(&ClientSessionUnix::on_connect,
+                                  std::static_pointer_cast<ClientSessionUnix>(shared_from_this())));
+}
+
+void
+ClientSessionUnix::on_connect(beast::error_code ec)
+{
+    if (ec)
+    {
+        return fail(ec, "connect");
+    }
+
+    // set timeout
+    beast::get_lowest_layer(*m_socket).expires_after(std::chrono::seconds(30));
+
+    // there is no host, the Host header is required
+    handshake("localhost", m_target);
+}
+
+} // namespace scaryws
+
+#endif // BOOST_ASIO_HAS_LOCAL_SOCKETS
@@ -0,0 +1,63 @@
+/* A websocket client using Boost.Beast
+ *
+ * (C) Copyright Ingo Randolf 2025.
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See
+ * accompanying file LICENSE or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ *
+ */
+
+#ifndef SCARYWS_CLIENT_SESSION_UNIX_H
+#define SCARYWS_CLIENT_SESSION_UNIX_H
+
+#include <string>
+
+#include <boost/beast/core.hpp>
+#include <boost/asio/local/stream_protocol.hpp>
+#include <boost/url.hpp>
+
+#include "BasicClientSession.h"
+
+// not every platform has unix domain sockets
+#ifdef BOOST_ASIO_HAS_LOCAL_SOCKETS
+
+namespace beast = boost::beast;         // from <boost/beast.hpp>
+namespace net = boost::asio;            // from <boost/asio.hpp>
+
+using stream_protocol = net::local::stream_protocol;
+
+namespace scaryws
+{
+
+// instantiated in ClientSessionUnix.cpp
+extern template class BasicClientSession<beast::basic_stream<stream_protocol>>;
+
+// a client connected to a unix domain socket
+// url: ws+unix:///path/to/socket:/request/path?query
+class ClientSessionUnix
+    : public BasicClientSession<beast::basic_stream<stream_protocol>>
+{
+public:
+    explicit ClientSessionUnix(net::io_context& ioc, bool binary = true);
+
+    void run(const boost::urls::url& url) override;
+
+private:
+    Stream* newStream() override;
+    void start() override;
+
+private:
+    void on_connect(beast::error_code ec);
+
+private:
+    // from the path of the url
+    std::string m_socketPath;
+    std::string m_target;
+};
+
+} // namespace scaryws
+
+#endif // BOOST_ASIO_HAS_LOCAL_SOCKETS
+
+#endif // SCARYWS_CLIENT_SESSION_UNIX_H
@@ -0,0 +1,159 @@
+/* A websocket client using Boost.Beast
+ *
+ * (C) Copyright Ingo Randolf 2025.
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See
+ * accompanying file LICENSE or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ *
+ */
+
+#include "ClientTlsContext.h"
+
+#include <boost/certify/extensions.hpp>
+#include <boost/certify/https_verification.hpp>
+
+namespace scaryws
+{
+
+// ex_data slots: the ClientTlsContext of a SSL_CTX and the cache key of a SSL
+static int contextIndex()
+{
+    static const int index = SSL_CTX_get_ex_new_index(0, nullptr, nullptr, nullptr, nullptr);
+    return index;
+}
+
+static int keyIndex()
+{
+    static const int index = SSL_get_ex_new_index(0, nullptr, nullptr, nullptr, nullptr);
+    return index;
+}
+
+ClientTlsContext::ClientTlsContext(bool verifyPeer)
+    : m_context(ssl::context::tls_client)
+    , m_verifyPeer(verifyPeer)
+{
+    if (m_verifyPeer)
+    {
+        m_context.set_verify_mode(net::ssl::verify_peer |
+                                  net::ssl::verify_fail_if_no_peer_cert);
+
+        m_context.set_default_verify_paths();
+
+        boost::certify::enable_native_https_server_verification(m_context);
+    }
+    else
+    {
+        m_context.set_verify_mode(net::ssl::verify_none);
+    }
+
+    // openssl does not look up client sessions on its own,
+    // new sessions are handed to newSession and kept in m_sessions.
+    // with TLS 1.3 the tickets arrive after the handshake.
+    SSL_CTX* ctx = m_context.native_handle();
+    SSL_CTX_set_ex_data(ctx, contextIndex(), this);
+    SSL_CTX_set_session_cache_mode(ctx, SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+    SSL_CTX_sess_set_new_cb(ctx, &ClientTlsContext::newSession);
+}
+
+ClientTlsContext::~ClientTlsContext()
+{
+    SSL_CTX_sess_set_new_cb(m_context.native_handle(), nullptr);
+    clearSessions();
+}
+
+std::shared_ptr<ClientTlsContext> ClientTlsContext::shared(bool verifyPeer)
+{
+    if (verifyPeer)
+    {
+        static const std::shared_ptr<ClientTlsContext> verifying = std::make_shared<ClientTlsContext>(true);
+        return verifying;
+    }
+
+    static const std::shared_ptr<ClientTlsContext> trusting = std::make_shared<ClientTlsContext>(false);
+    return trusting;
+}
+
+ssl::context& ClientTlsContext::context()
+{
+    return m_context;
+}
+
+bool ClientTlsContext::verifyPeer() const
+{
+    return m_verifyPeer;
+}
+
+void ClientTlsContext::prepare(SSL* ssl, const std::string* key)
+{
+    SSL_set_ex_data(ssl, keyIndex(), const_cast<std::string*>(key));
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto it = m_sessions.find(*key);
+    if (it == m_sessions.end())
+    {
+        return;
+    }
+
+    if (SSL_SESSION_is_resumable(it->second) != 1)
+    {
+        SSL_SESSION_free(it->second);
+        m_sessions.erase(it);
+        return;
+    }
+
+    // SSL_set_session takes its own reference
+    SSL_set_session(ssl, it->second);
+}
+
+void ClientTlsContext::clearSessions()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    for (auto& entry : m_sessions)
+    {
+        SSL_SESSION_free(entry.second);
+    }
+
+    m_sessions.clear();
+}
+
+size_t ClientTlsContext::sessionCount() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_sessions.size();
+}
+
+int ClientTlsContext::newSession(SSL* ssl, SSL_SESSION* session)
+{
+    auto self = static_cast<ClientTlsContext*>(SSL_CTX_get_ex_data(SSL_get_SSL_CTX(ssl), contextIndex()));
+    auto key = static_cast<const std::string*>(SSL_get_ex_data(ssl, keyIndex()));
+
+    if (!self || !key)
+    {
+        // not taken, openssl frees the session
+        return 0;
+    }
+
+    self->store(*key, session);
+
+    // the reference of session is taken over
+    return 1;
+}
+
+void ClientTlsContext::store(const std::string& key, SSL_SESSION* session)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    SSL_SESSION*& entry = m_sessions[key];
+
+    if (entry)
+    {
+        SSL_SESSION_free(entry);
+    }
+
+    entry = session;
+}
+
+} // namespace scaryws
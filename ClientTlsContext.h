@@ -0,0 +1,70 @@
+/* A websocket client using Boost.Beast
+ *
+ * (C) Copyright Ingo Randolf 2025.
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See
+ * accompanying file LICENSE or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ *
+ */
+
+#ifndef SCARYWS_CLIENT_TLS_CONTEXT_H
+#define SCARYWS_CLIENT_TLS_CONTEXT_H
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include <boost/asio/ssl.hpp>
+
+namespace net = boost::asio;            // from <boost/asio.hpp>
+namespace ssl = boost::asio::ssl;       // from <boost/asio/ssl.hpp>
+
+namespace scaryws
+{
+
+// ssl::context for wss:// clients with a cache of TLS sessions
+//
+// the context is set up once and can be used by many clients.
+// sessions (or session tickets) the servers hand out are kept per
+// host:port, a reconnect to the same server offers the cached session
+// and gets an abbreviated handshake.
+class ClientTlsContext
+{
+public:
+    explicit ClientTlsContext(bool verifyPeer = true);
+    ~ClientTlsContext();
+
+    ClientTlsContext(const ClientTlsContext&) = delete;
+    ClientTlsContext& operator=(const ClientTlsContext&) = delete;
+
+    // one process-wide context per verify mode
+    static std::shared_ptr<ClientTlsContext> shared(bool verifyPeer);
+
+    ssl::context& context();
+    bool verifyPeer() const;
+
+    // offer the cached session for key with the next handshake of ssl
+    // new sessions of this connection are stored under key.
+    // key must stay valid as long as ssl is used.
+    void prepare(SSL* ssl, const std::string* key);
+
+    void clearSessions();
+    size_t sessionCount() const;
+
+private:
+    static int newSession(SSL* ssl, SSL_SESSION* session);
+    void store(const std::string& key, SSL_SESSION* session);
+
+private:
+    ssl::context m_context;
+    const bool m_verifyPeer;
+
+    mutable std::mutex m_mutex;
+    std::unordered_map<std::string, SSL_SESSION*> m_sessions;
+};
+
+} // namespace scaryws
+
+#endif // SCARYWS_CLIENT_TLS_CONTEXT_H
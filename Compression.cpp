@@ -0,0 +1,176 @@
+/* A websocket server and client using Boost.Beast
+ *
+ * (C) Copyright Ingo Randolf 2025.
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See
+ * accompanying file LICENSE or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ *
+ */
+
+#include "Compression.h"
+
+#include <algorithm>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+#include <boost/beast/zlib/deflate_stream.hpp>
+
+// beast does not expose the negotiated parameters of a stream.
+// the same functions beast uses during the handshake are used
+// to get them from the handshake messages. they are internals of
+// beast, only negotiate below uses them. checked with Boost 1.74,
+// the asserts stop the build if they change.
+#include <boost/beast/websocket/detail/pmd_extension.hpp>
+
+namespace scaryws
+{
+
+namespace pmd = websocket::detail;
+
+static_assert(std::is_same<decltype(&pmd::pmd_read<std::allocator<char>>),
+                           void (*)(pmd::pmd_offer&, const http::fields&)>::value,
+              "beast changed pmd_read, check negotiate in Compression.cpp");
+
+static_assert(std::is_same<decltype(&pmd::pmd_negotiate<std::allocator<char>>),
+                           void (*)(http::fields&,
+                                    pmd::pmd_offer&,
+                                    const pmd::pmd_offer&,
+                                    const websocket::permessage_deflate&)>::value,
+              "beast changed pmd_negotiate, check negotiate in Compression.cpp");
+
+static_assert(std::is_same<decltype(pmd::pmd_offer::accept), bool>::value &&
+              std::is_same<decltype(pmd::pmd_offer::server_max_window_bits), int>::value &&
+              std::is_same<decltype(pmd::pmd_offer::client_max_window_bits), int>::value &&
+              std::is_same<decltype(pmd::pmd_offer::server_no_context_takeover), bool>::value &&
+              std::is_same<decltype(pmd::pmd_offer::client_no_context_takeover), bool>::value,
+              "beast changed pmd_offer, check negotiate in Compression.cpp");
+
+// the permessage-deflate parameters in the extension field of fields
+// server: negotiate them as the server would, null to read them as they are
+static NegotiatedCompression negotiate(const http::fields& fields,
+                                       const websocket::permessage_deflate* server)
+{
+    pmd::pmd_offer config{};
+    pmd::pmd_read(config, fields);
+
+    if (server)
+    {
+        const pmd::pmd_offer offer = config;
+        http::fields response;
+        pmd::pmd_negotiate(response, config, offer, *server);
+    }
+
+    NegotiatedCompression result;
+
+    result.enabled = config.accept;
+
+    if (!result.enabled)
+    {
+        return result;
+    }
+
+    // 0: not present, -1: present without value
+    result.serverMaxWindowBits = config.server_max_window_bits > 0 ? config.server_max_window_bits : 15;
+    result.clientMaxWindowBits = config.client_max_window_bits > 0 ? config.client_max_window_bits : 15;
+    result.serverNoContextTakeover = config.server_no_context_takeover;
+    result.clientNoContextTakeover = config.client_no_context_takeover;
+
+    return result;
+}
+
+websocket::permessage_deflate permessageDeflate(const CompressionOptions& options)
+{
+    websocket::permessage_deflate pmd;
+
+    pmd.server_enable = options.enabled;
+    pmd.client_enable = options.enabled;
+    pmd.server_max_window_bits = options.serverMaxWindowBits;
+    pmd.client_max_window_bits = options.clientMaxWindowBits;
+    pmd.server_no_context_takeover = options.serverNoContextTakeover;
+    pmd.client_no_context_takeover = options.clientNoContextTakeover;
+    pmd.memLevel = options.memLevel;
+    pmd.compLevel = options.compressionLevel;
+
+    return pmd;
+}
+
+NegotiatedCompression negotiateCompression(const http::request<http::string_body>& request,
+                                           const CompressionOptions& options)
+{
+    const websocket::permessage_deflate server = permessageDeflate(options);
+
+    return negotiate(request, &server);
+}
+
+NegotiatedCompression negotiatedCompression(const websocket::response_type& response)
+{
+    return negotiate(response, nullptr);
+}
+
+bool shouldCompress(CompressionMode mode, size_t size, const CompressionOptions& options)
+{
+    switch (mode)
+    {
+    case CompressionMode::Always:
+        return true;
+    case CompressionMode::Never:
+        return false;
+    case CompressionMode::Auto:
+        break;
+    }
+
+    return size >= options.threshold;
+}
+
+SharedBuffer deflateMessage(const SharedBuffer& payload,
+                            int windowBits,
+                            const CompressionOptions& options)
+{
+    if (payload.empty())
+    {
+        return SharedBuffer();
+    }
+
+    beast::zlib::deflate_stream stream;
+    stream.reset(options.compressionLevel,
+                 windowBits,
+                 options.memLevel,
+                 beast::zlib::Strategy::normal);
+
+    // room for the sync flush marker
+    std::vector<char> out(stream.upper_bound(payload.size()) + 8);
+
+    beast::zlib::z_params zs;
+    zs.next_in = payload.data();
+    zs.avail_in = payload.size();
+    zs.next_out = out.data();
+    zs.avail_out = out.size();
+
+    beast::error_code ec;
+    stream.write(zs, beast::zlib::Flush::sync, ec);
+
+    if (ec ||
+        zs.avail_in > 0 ||
+        zs.total_out < 4)
+    {
+        return SharedBuffer();
+    }
+
+    // remove the empty block of the sync flush (RFC 7692, 7.2.1)
+    const size_t size = zs.total_out - 4;
+    static const char tail[4] = { '\x00', '\x00', '\xff', '\xff' };
+
+    if (!std::equal(tail, tail + 4, out.data() + size) ||
+        size >= payload.size())
+    {
+        return SharedBuffer();
+    }
+
+    out.resize(size);
+
+    return SharedBuffer(std::move(out));
+}
+
+} // namespace scaryws
@@ -0,0 +1,95 @@
+/* A websocket server and client using Boost.Beast
+ *
+ * (C) Copyright Ingo Randolf 2025.
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See
+ * accompanying file LICENSE or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ *
+ */
+
+#ifndef SCARYWS_COMPRESSION_H
+#define SCARYWS_COMPRESSION_H
+
+#include "SharedBuffer.h"
+
+#include <boost/beast/http.hpp>
+#include <boost/beast/websocket.hpp>
+
+namespace beast = boost::beast;
+namespace http = beast::http;
+namespace websocket = beast::websocket;
+
+namespace scaryws
+{
+
+// compression of a single message
+// Auto: compress if the message is at least CompressionOptions::threshold bytes
+// has no effect if permessage-deflate was not negotiated
+enum class CompressionMode
+{
+    Auto,
+    Always,
+    Never
+};
+
+// permessage-deflate settings (RFC 7692)
+// window bits must be between 9 and 15
+struct CompressionOptions
+{
+    bool enabled{false};
+
+    // window bits the server uses to compress, offered or accepted
+    int serverMaxWindowBits{15};
+
+    // window bits the client uses to compress, offered or accepted
+    int clientMaxWindowBits{15};
+
+    // reset the compression context after each message
+    // saves memory per connection, costs compression ratio
+    bool serverNoContextTakeover{false};
+    bool clientNoContextTakeover{false};
+
+    // zlib memory level 1..9 and compression level 0..9
+    int memLevel{4};
+    int compressionLevel{8};
+
+    // smaller messages are sent uncompressed with CompressionMode::Auto
+    // compressing small messages costs more time than it saves
+    size_t threshold{0};
+};
+
+// whether a message of this size is compressed
+bool shouldCompress(CompressionMode mode, size_t size, const CompressionOptions& options);
+
+// permessage-deflate parameters of a connection after the handshake
+struct NegotiatedCompression
+{
+    bool enabled{false};
+    int serverMaxWindowBits{15};
+    int clientMaxWindowBits{15};
+    bool serverNoContextTakeover{false};
+    bool clientNoContextTakeover{false};
+};
+
+websocket::permessage_deflate permessageDeflate(const CompressionOptions& options);
+
+// the parameters a server accepts for a handshake request
+NegotiatedCompression negotiateCompression(const http::request<http::string_body>& request,
+                                           const CompressionOptions& options);
+
+// the parameters a server accepted in its handshake response
+NegotiatedCompression negotiatedCompression(const websocket::response_type& response);
+
+// compress a message without context takeover
+// the result is the payload of a frame with RSV1 set.
+// it can be sent to every client which negotiated server_no_context_takeover
+// and at least windowBits server window bits.
+// returns an empty buffer if the message does not get smaller
+SharedBuffer deflateMessage(const SharedBuffer& payload,
+                            int windowBits,
+                            const CompressionOptions& options);
+
+} // namespace scaryws
+
+#endif // SCARYWS_COMPRESSION_H
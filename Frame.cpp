@@ -0,0 +1,112 @@
+/* A websocket server and client using Boost.Beast
+ *
+ * (C) Copyright Ingo Randolf 2025.
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See
+ * accompanying file LICENSE or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ *
+ */
+
+#include "Frame.h"
+
+namespace scaryws
+{
+
+FrameHeader::FrameHeader()
+{}
+
+FrameHeader::FrameHeader(bool binary, size_t payloadSize)
+{
+    // FIN and opcode
+    m_data[0] = 0x80 | (binary ? 0x2 : 0x1);
+
+    // payload length, not masked
+    if (payloadSize < 126)
+    {
+        m_data[1] = static_cast<uint8_t>(payloadSize);
+        m_size = 2;
+    }
+    else if (payloadSize <= 0xffff)
+    {
+        m_data[1] = 126;
+        m_data[2] = static_cast<uint8_t>(payloadSize >> 8);
+        m_data[3] = static_cast<uint8_t>(payloadSize);
+        m_size = 4;
+    }
+    else
+    {
+        const uint64_t size = payloadSize;
+
+        m_data[1] = 127;
+        for (int i = 0; i < 8; i++)
+        {
+            m_data[2 + i] = static_cast<uint8_t>(size >> (56 - 8 * i));
+        }
+        m_size = 10;
+    }
+}
+
+FrameHeader::FrameHeader(bool binary, size_t payloadSize, uint32_t maskKey)
+    : FrameHeader(binary, payloadSize)
+{
+    // mask bit and masking key
+    m_data[1] |= 0x80;
+
+    for (int i = 0; i < 4; i++)
+    {
+        m_data[m_size++] = static_cast<uint8_t>(maskKey >> (24 - 8 * i));
+    }
+}
+
+bool FrameHeader::empty() const
+{
+    return m_size == 0;
+}
+
+size_t FrameHeader::size() const
+{
+    return m_size;
+}
+
+void FrameHeader::compressed(bool compressed)
+{
+    if (compressed)
+    {
+        m_data[0] |= 0x40;
+    }
+    else
+    {
+        m_data[0] &= ~0x40;
+    }
+}
+
+bool FrameHeader::compressed() const
+{
+    return m_size > 0 &&
+            (m_data[0] & 0x40) != 0;
+}
+
+net::const_buffer FrameHeader::buffer() const
+{
+    return net::const_buffer(m_data, m_size);
+}
+
+
+void applyMask(char* data, size_t size, uint32_t maskKey)
+{
+    // key bytes in the order of the header
+    const uint8_t key[4] = {
+        static_cast<uint8_t>(maskKey >> 24),
+        static_cast<uint8_t>(maskKey >> 16),
+        static_cast<uint8_t>(maskKey >> 8),
+        static_cast<uint8_t>(maskKey)
+    };
+
+    for (size_t i = 0; i < size; i++)
+    {
+        data[i] ^= key[i & 3];
+    }
+}
+
+} // namespace scaryws
@@ -0,0 +1,54 @@
+/* A websocket server and client using Boost.Beast
+ *
+ * (C) Copyright Ingo Randolf 2025.
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See
+ * accompanying file LICENSE or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ *
+ */
+
+#ifndef SCARYWS_FRAME_H
+#define SCARYWS_FRAME_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include <boost/asio/buffer.hpp>
+
+namespace net = boost::asio;
+
+namespace scaryws
+{
+
+// header of a single, unfragmented websocket data frame (RFC 6455, 5.2)
+// frames sent by a server are not masked. the header only depends on
+// the message type and the payload size and is the same for all clients.
+// frames sent by a client are masked with a key which is part of the header.
+class FrameHeader
+{
+public:
+    FrameHeader();
+    FrameHeader(bool binary, size_t payloadSize);
+    FrameHeader(bool binary, size_t payloadSize, uint32_t maskKey);
+
+    bool empty() const;
+    size_t size() const;
+
+    // RSV1, the payload is compressed with permessage-deflate
+    void compressed(bool compressed);
+    bool compressed() const;
+
+    net::const_buffer buffer() const;
+
+private:
+    uint8_t m_data[14];
+    uint8_t m_size{0};
+};
+
+// mask or unmask payload data in place
+void applyMask(char* data, size_t size, uint32_t maskKey);
+
+} // namespace scaryws
+
+#endif // SCARYWS_FRAME_H
@@ -0,0 +1,373 @@
+/* A websocket server and client using Boost.Beast
+ *
+ * (C) Copyright Ingo Randolf 2025.
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See
+ * accompanying file LICENSE or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ *
+ */
+
+#ifndef SCARYWS_GUARDED_STREAM_H
+#define SCARYWS_GUARDED_STREAM_H
+
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+#include <boost/beast/core.hpp>
+#include <boost/beast/websocket.hpp>
+#include <boost/asio/associated_allocator.hpp>
+#include <boost/asio/associated_executor.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/write.hpp>
+
+namespace beast = boost::beast;
+namespace net = boost::asio;
+
+namespace scaryws
+{
+
+template<class NextLayer>
+class GuardedStream;
+
+namespace detail
+{
+
+// a write on a GuardedStream
+// waits until the stream allows the write, starts it on the next layer
+// and releases the stream when it completed
+template<class NextLayer, class ConstBufferSequence, class Handler, bool Raw>
+class guarded_write_op
+{
+public:
+    template<class DeducedHandler>
+    guarded_write_op(GuardedStream<NextLayer>& stream,
+                     const ConstBufferSequence& buffers,
+                     DeducedHandler&& handler)
+        : m_stream(&stream)
+        , m_buffers(buffers)
+        , m_handler(std::forward<DeducedHandler>(handler))
+    {}
+
+    // the write was started on the next layer
+    void started()
+    {
+        m_started = true;
+    }
+
+    const ConstBufferSequence& buffers() const
+    {
+        return m_buffers;
+    }
+
+    const Handler& handler() const
+    {
+        return m_handler;
+    }
+
+    // woken up, try again
+    void operator()(beast::error_code)
+    {
+        m_stream->start(std::move(*this));
+    }
+
+    // write completed, or refused without being started
+    void operator()(beast::error_code ec, std::size_t bytes_transferred)
+    {
+        if (m_started)
+        {
+            m_stream->release(Raw, ec, bytes_transferred);
+        }
+
+        m_handler(ec, bytes_transferred);
+    }
+
+private:
+    GuardedStream<NextLayer>* m_stream;
+    ConstBufferSequence m_buffers;
+    Handler m_handler;
+    bool m_started{false};
+};
+
+// the size of the websocket frame at the start of buffers
+// close is set for a close frame
+template<class ConstBufferSequence>
+std::size_t frameSize(const ConstBufferSequence& buffers, bool& close)
+{
+    unsigned char header[14];
+    const std::size_t available = net::buffer_copy(net::buffer(header), buffers);
+
+    close = false;
+
+    if (available < 2)
+    {
+        return net::buffer_size(buffers);
+    }
+
+    close = (header[0] & 0x0f) == 0x08;
+
+    std::size_t size = 2;
+    uint64_t length = header[1] & 0x7f;
+
+    if (length == 126)
+    {
+        size += 2;
+    }
+    else if (length == 127)
+    {
+        size += 8;
+    }
+
+    if (available < size)
+    {
+        return net::buffer_size(buffers);
+    }
+
+    if (length == 126)
+    {
+        length = (uint64_t(header[2]) << 8) | header[3];
+    }
+    else if (length == 127)
+    {
+        length = 0;
+
+        for (std::size_t i = 2; i < 10; i++)
+        {
+            length = (length << 8) | header[i];
+        }
+    }
+
+    // masking key
+    if (header[1] & 0x80)
+    {
+        size += 4;
+    }
+
+    return size + static_cast<std::size_t>(length);
+}
+
+} // namespace detail
+
+
+// A stream layer between websocket::stream and its transport.
+//
+// Writes complete frames (raw bytes) to the transport without
+// interleaving them with the frames websocket::stream writes on its own,
+// e.g. pings, pongs or close frames.
+// A raw write waits until the websocket stream wrote its current frame,
+// which can take several write_some calls, and writes of the websocket
+// stream wait for a pending raw write.
+// After the websocket stream started a close frame, raw writes fail
+// with operation_aborted.
+// Writes before open() are the http handshake and are not looked at
+// as frames.
+//
+// Like the stream it wraps, it must only be used on one strand.
+template<class NextLayer>
+class GuardedStream
+{
+    template<class, class, class, bool>
+    friend class detail::guarded_write_op;
+
+public:
+    using next_layer_type = NextLayer;
+    using executor_type = typename NextLayer::executor_type;
+
+    template<class... Args>
+    explicit GuardedStream(Args&&... args)
+        : m_next(std::forward<Args>(args)...)
+        , m_wake(m_next.get_executor())
+    {
+        m_wake.expires_at(net::steady_timer::time_point::max());
+    }
+
+    executor_type get_executor() noexcept
+    {
+        return m_next.get_executor();
+    }
+
+    next_layer_type& next_layer() noexcept
+    {
+        return m_next;
+    }
+
+    const next_layer_type& next_layer() const noexcept
+    {
+        return m_next;
+    }
+
+    template<class MutableBufferSequence, class ReadHandler>
+    void async_read_some(const MutableBufferSequence& buffers, ReadHandler&& handler)
+    {
+        m_next.async_read_some(buffers, std::forward<ReadHandler>(handler));
+    }
+
+    // the websocket handshake is done,
+    // the websocket stream writes frames from now on
+    void open()
+    {
+        m_open = true;
+    }
+
+    // used by websocket::stream
+    template<class ConstBufferSequence, class WriteHandler>
+    void async_write_some(const ConstBufferSequence& buffers, WriteHandler&& handler)
+    {
+        start(detail::guarded_write_op<NextLayer,
+                                       ConstBufferSequence,
+                                       typename std::decay<WriteHandler>::type,
+                                       false>(*this, buffers, std::forward<WriteHandler>(handler)));
+    }
+
+    // write all buffers as they are
+    // the buffers must contain complete websocket frames
+    template<class ConstBufferSequence, class WriteHandler>
+    void async_write_raw(const ConstBufferSequence& buffers, WriteHandler&& handler)
+    {
+        start(detail::guarded_write_op<NextLayer,
+                                       ConstBufferSequence,
+                                       typename std::decay<WriteHandler>::type,
+                                       true>(*this, buffers, std::forward<WriteHandler>(handler)));
+    }
+
+private:
+    template<class ConstBufferSequence, class Handler, bool Raw>
+    void start(detail::guarded_write_op<NextLayer, ConstBufferSequence, Handler, Raw>&& op)
+    {
+        // a raw write waits for all other writes
+        // other writes only wait for a raw write
+        if (Raw && m_closeSent)
+        {
+            // no data frames after a close frame
+            net::post(beast::bind_front_handler(std::move(op),
+                                                beast::error_code(net::error::operation_aborted),
+                                                std::size_t(0)));
+            return;
+        }
+
+        if (m_raw ||
+            (Raw && m_writing))
+        {
+            m_wake.async_wait(std::move(op));
+            return;
+        }
+
+        const ConstBufferSequence buffers = op.buffers();
+        op.started();
+
+        if (Raw)
+        {
+            m_raw = true;
+            net::async_write(m_next, buffers, std::move(op));
+            return;
+        }
+
+        // the websocket stream starts a new frame
+        if (m_open &&
+            m_frameRemaining == 0)
+        {
+            bool close = false;
+            m_frameRemaining = detail::frameSize(buffers, close);
+            m_closeSent = m_closeSent || close;
+        }
+
+        m_writing = true;
+        m_next.async_write_some(buffers, std::move(op));
+    }
+
+    void release(bool raw, beast::error_code ec, std::size_t bytes_transferred)
+    {
+        if (raw)
+        {
+            m_raw = false;
+        }
+        else
+        {
+            m_frameRemaining = ec || bytes_transferred >= m_frameRemaining ? 0
+                                                                           : m_frameRemaining - bytes_transferred;
+
+            // keep the guard until the frame is written
+            if (m_frameRemaining > 0)
+            {
+                return;
+            }
+
+            m_writing = false;
+        }
+
+        // wake up waiting writes
+        m_wake.cancel();
+    }
+
+private:
+    NextLayer m_next;
+    net::steady_timer m_wake;
+
+    bool m_open{false};
+    bool m_raw{false};
+    bool m_writing{false};
+    // bytes of the current frame of the websocket stream not written yet
+    std::size_t m_frameRemaining{0};
+    bool m_closeSent{false};
+};
+
+
+// websocket teardown of the next layer
+
+template<class NextLayer>
+void teardown(beast::role_type role,
+              GuardedStream<NextLayer>& stream,
+              beast::error_code& ec)
+{
+    using beast::websocket::teardown;
+    teardown(role, stream.next_layer(), ec);
+}
+
+template<class NextLayer, class TeardownHandler>
+void async_teardown(beast::role_type role,
+                    GuardedStream<NextLayer>& stream,
+                    TeardownHandler&& handler)
+{
+    using beast::websocket::async_teardown;
+    async_teardown(role, stream.next_layer(), std::forward<TeardownHandler>(handler));
+}
+
+} // namespace scaryws
+
+
+// the write operations run on the executor and allocator of their handler
+
+namespace boost
+{
+namespace asio
+{
+
+template<class NextLayer, class ConstBufferSequence, class Handler, bool Raw, class Executor>
+struct associated_executor<scaryws::detail::guarded_write_op<NextLayer, ConstBufferSequence, Handler, Raw>, Executor>
+{
+    using type = typename associated_executor<Handler, Executor>::type;
+
+    static type get(const scaryws::detail::guarded_write_op<NextLayer, ConstBufferSequence, Handler, Raw>& op,
+                    const Executor& ex = Executor()) noexcept
+    {
+        return associated_executor<Handler, Executor>::get(op.handler(), ex);
+    }
+};
+
+template<class NextLayer, class ConstBufferSequence, class Handler, bool Raw, class Allocator>
+struct associated_allocator<scaryws::detail::guarded_write_op<NextLayer, ConstBufferSequence, Handler, Raw>, Allocator>
+{
+    using type = typename associated_allocator<Handler, Allocator>::type;
+
+    static type get(const scaryws::detail::guarded_write_op<NextLayer, ConstBufferSequence, Handler, Raw>& op,
+                    const Allocator& alloc = Allocator()) noexcept
+    {
+        return associated_allocator<Handler, Allocator>::get(op.handler(), alloc);
+    }
+};
+
+} // namespace asio
+} // namespace boost
+
+#endif // SCARYWS_GUARDED_STREAM_H
@@ -0,0 +1,164 @@
+/* A websocket server and client using Boost.Beast
+ *
+ * (C) Copyright Ingo Randolf 2025.
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See
+ * accompanying file LICENSE or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ *
+ */
+
+#include "Histogram.h"
+
+#include <cmath>
+
+namespace scaryws
+{
+
+// the index of the highest set bit
+static unsigned highestBit(uint64_t value)
+{
+#if defined(__GNUC__)
+    return 63 - __builtin_clzll(value);
+#else
+    unsigned bit = 0;
+
+    while (value >>= 1)
+    {
+        bit++;
+    }
+
+    return bit;
+#endif
+}
+
+size_t latencyBucket(uint64_t value)
+{
+    if (value < LatencySubBuckets)
+    {
+        return static_cast<size_t>(value);
+    }
+
+    const unsigned bit = highestBit(value);
+
+    if (bit >= 32)
+    {
+        return LatencyBuckets - 1;
+    }
+
+    // the 3 bits below the highest one select the sub-bucket
+    const unsigned shift = bit - 3;
+
+    return LatencySubBuckets +
+            shift * LatencySubBuckets +
+            static_cast<size_t>((value >> shift) & (LatencySubBuckets - 1));
+}
+
+uint64_t latencyBucketMax(size_t bucket)
+{
+    if (bucket < LatencySubBuckets)
+    {
+        return bucket;
+    }
+
+    const unsigned shift = static_cast<unsigned>((bucket - LatencySubBuckets) / LatencySubBuckets);
+    const uint64_t sub = (bucket - LatencySubBuckets) % LatencySubBuckets;
+
+    return ((LatencySubBuckets + sub + 1) << shift) - 1;
+}
+
+
+uint64_t LatencySnapshot::count() const
+{
+    uint64_t total = 0;
+
+    for (auto count : counts)
+    {
+        total += count;
+    }
+
+    return total;
+}
+
+std::chrono::microseconds LatencySnapshot::percentile(double fraction) const
+{
+    const uint64_t total = count();
+
+    if (total == 0)
+    {
+        return std::chrono::microseconds(0);
+    }
+
+    // the rank of the sample, 1 based
+    uint64_t rank = static_cast<uint64_t>(std::ceil(fraction * static_cast<double>(total)));
+
+    if (rank < 1)
+    {
+        rank = 1;
+    }
+
+    uint64_t seen = 0;
+
+    for (size_t i = 0; i < LatencyBuckets; i++)
+    {
+        seen += counts[i];
+
+        if (seen >= rank)
+        {
+            return std::chrono::microseconds(latencyBucketMax(i));
+        }
+    }
+
+    return std::chrono::microseconds(latencyBucketMax(LatencyBuckets - 1));
+}
+
+LatencySnapshot& LatencySnapshot::operator+=(const LatencySnapshot& other)
+{
+    for (size_t i = 0; i < LatencyBuckets; i++)
+    {
+        counts[i] += other.counts[i];
+    }
+
+    return *this;
+}
+
+
+LatencyHistogram::LatencyHistogram()
+{
+    for (auto& count : m_counts)
+    {
+        count.store(0, std::memory_order_relaxed);
+    }
+}
+
+void LatencyHistogram::record(std::chrono::microseconds value)
+{
+    const uint64_t us = value.count() > 0 ? static_cast<uint64_t>(value.count()) : 0;
+
+    m_counts[latencyBucket(us)].fetch_add(1, std::memory_order_relaxed);
+}
+
+void LatencyHistogram::add(const LatencySnapshot& snapshot)
+{
+    for (size_t i = 0; i < LatencyBuckets; i++)
+    {
+        if (snapshot.counts[i] > 0)
+        {
+            m_counts[i].fetch_add(snapshot.counts[i], std::memory_order_relaxed);
+        }
+    }
+}
+
+LatencySnapshot LatencyHistogram::snapshot() const
+{
+    LatencySnapshot snapshot;
+
+    for (size_t i = 0; i < LatencyBuckets; i++)
+    {
+        snapshot.counts[i] = m_counts[i].load(std::memory_order_relaxed);
+    }
+
+    return snapshot;
+}
+
+} // namespace scaryws
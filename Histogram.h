@@ -0,0 +1,64 @@
+/* A websocket server and client using Boost.Beast
+ *
+ * (C) Copyright Ingo Randolf 2025.
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See
+ * accompanying file LICENSE or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ *
+ */
+
+#ifndef SCARYWS_HISTOGRAM_H
+#define SCARYWS_HISTOGRAM_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace scaryws
+{
+
+// log-linear buckets of microseconds
+// values below 8 have a bucket each, every power of two above is split
+// into 8 buckets, about 12% wide. values from 2^32 (71 minutes) on
+// go into the last bucket.
+constexpr size_t LatencySubBuckets = 8;
+constexpr size_t LatencyBuckets = LatencySubBuckets + 29 * LatencySubBuckets;
+
+// the bucket counts of a histogram
+struct LatencySnapshot
+{
+    uint64_t counts[LatencyBuckets] = {};
+
+    uint64_t count() const;
+
+    // the value below which fraction of the samples are, e.g. 0.99
+    // reported as the upper end of its bucket, 0 without samples
+    std::chrono::microseconds percentile(double fraction) const;
+
+    LatencySnapshot& operator+=(const LatencySnapshot& other);
+};
+
+// records durations without locking, a snapshot can be taken from any thread
+class LatencyHistogram
+{
+public:
+    LatencyHistogram();
+
+    void record(std::chrono::microseconds value);
+    void add(const LatencySnapshot& snapshot);
+
+    LatencySnapshot snapshot() const;
+
+private:
+    std::atomic<uint64_t> m_counts[LatencyBuckets];
+};
+
+size_t latencyBucket(uint64_t value);
+// the largest value of bucket
+uint64_t latencyBucketMax(size_t bucket);
+
+} // namespace scaryws
+
+#endif // SCARYWS_HISTOGRAM_H
@@ -11,8 +11,13 @@
 #ifndef SCARYWS_I_CLIENT_SESSION_LISTENER_H
 #define SCARYWS_I_CLIENT_SESSION_LISTENER_H
 
+#include <chrono>
 #include <cstdint>
 #include <string>
+#include <utility>
+#include <vector>
+
+#include "StreamingReceive.h"
 
 namespace scaryws
 {
@@ -25,6 +30,48 @@ public:
     virtual void disconnected(uint16_t code) = 0;
     virtual void received(const char* data, size_t size) = 0;
     virtual void received(const std::string& msg) = 0;
+
+    // received a message without copying it
+    // data is only valid during the call
+    // default: calls received above
+    virtual void receivedView(const char* data, size_t size, bool binary)
+    {
+        if (binary)
+        {
+            received(data, size);
+        }
+        else
+        {
+            received(std::string(data, size));
+        }
+    }
+
+    // received a message, the data is moved out of the read buffer
+    // only called if the session is set to move received data
+    // default: calls receivedView
+    virtual void receivedOwned(std::vector<char>&& data, bool binary)
+    {
+        receivedView(data.data(), data.size(), binary);
+    }
+
+    // received a chunk of a message
+    // only called if the session is set to streaming receive,
+    // instead of the functions above. data is only valid during the call.
+    // a message cut off by a lost connection ends without Final
+    // return false for the first chunk if chunks are not handled,
+    // the session then reads whole messages and passes them on as if
+    // streaming receive was off
+    // default: returns false
+    virtual bool receivedChunk(const char* /*data*/, size_t /*size*/, bool /*binary*/, ChunkMarker /*marker*/)
+    {
+        return false;
+    }
+
+    // a round trip took longer than the ping threshold,
+    // or a ping is not answered within it
+    virtual void rttExceeded(std::chrono::microseconds /*rtt*/)
+    {
+    }
 };
 
 } // namespace scaryws
@@ -11,24 +11,82 @@
 #ifndef SCARYWS_I_SERVER_SESSION_LISTENER_H
 #define SCARYWS_I_SERVER_SESSION_LISTENER_H
 
+#include <chrono>
+#include <cstdint>
 #include <string>
+#include <utility>
+#include <vector>
+
+#include "StreamingReceive.h"
 
 namespace scaryws
 {
 
+// identifies a connected client
+// ids are never reused, 0 is no client
+using ClientId = uint64_t;
+
 class IServerSessionListener
 {
 public:
     virtual void listening() = 0;
     virtual void closed() = 0;
-    virtual void clientConnected(void* client) = 0;
-    virtual void clientDisconnected(void* client) = 0;
+    virtual void clientConnected(ClientId client) = 0;
+    virtual void clientDisconnected(ClientId client) = 0;
+
+    // the server could not start, e.g. the certificate could not be loaded
+    // default: does nothing
+    virtual void error(int /*code*/, const std::string& /*message*/)
+    {
+    }
 
     // received binary data
-    virtual void received(const char* data, size_t size, void* client) = 0;
+    virtual void received(const char* data, size_t size, ClientId client) = 0;
 
     // received text data
-    virtual void received(const std::string& msg, void* client) = 0;
+    virtual void received(const std::string& msg, ClientId client) = 0;
+
+    // received a message without copying it
+    // data is only valid during the call
+    // default: calls received above
+    virtual void receivedView(const char* data, size_t size, bool binary, ClientId client)
+    {
+        if (binary)
+        {
+            received(data, size, client);
+        }
+        else
+        {
+            received(std::string(data, size), client);
+        }
+    }
+
+    // received a message, the data is moved out of the read buffer
+    // only called if the session is set to move received data
+    // default: calls receivedView
+    virtual void receivedOwned(std::vector<char>&& data, bool binary, ClientId client)
+    {
+        receivedView(data.data(), data.size(), binary, client);
+    }
+
+    // received a chunk of a message
+    // only called if the session is set to streaming receive,
+    // instead of the functions above. data is only valid during the call.
+    // a message cut off by a lost connection ends without Final
+    // return false for the first chunk if chunks are not handled,
+    // the session then reads whole messages and passes them on as if
+    // streaming receive was off
+    // default: returns false
+    virtual bool receivedChunk(const char* /*data*/, size_t /*size*/, bool /*binary*/, ChunkMarker /*marker*/, ClientId /*client*/)
+    {
+        return false;
+    }
+
+    // a round trip took longer than the ping threshold,
+    // or a ping is not answered within it
+    virtual void rttExceeded(std::chrono::microseconds /*rtt*/, ClientId /*client*/)
+    {
+    }
 };
 
 } // namespace scaryws
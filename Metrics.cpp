@@ -0,0 +1,255 @@
+/* A websocket server and client using Boost.Beast
+ *
+ * (C) Copyright Ingo Randolf 2025.
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See
+ * accompanying file LICENSE or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ *
+ */
+
+#include "Metrics.h"
+
+#include <algorithm>
+
+#include <boost/asio/error.hpp>
+#include <boost/asio/ssl/error.hpp>
+#include <boost/beast/http/error.hpp>
+#include <boost/beast/websocket/error.hpp>
+
+namespace net = boost::asio;
+
+namespace scaryws
+{
+
+HandshakeFailure handshakeFailure(const beast::error_code& ec)
+{
+    if (ec == beast::error::timeout ||
+        ec == net::error::timed_out)
+    {
+        return HandshakeFailure::Timeout;
+    }
+
+    if (ec.category() == net::error::get_ssl_category() ||
+        ec.category() == net::ssl::error::get_stream_category())
+    {
+        return HandshakeFailure::Tls;
+    }
+
+    if (ec.category() == beast::http::make_error_code(beast::http::error::end_of_stream).category())
+    {
+        return HandshakeFailure::Http;
+    }
+
+    if (ec.category() == beast::websocket::make_error_code(beast::websocket::error::closed).category())
+    {
+        return ec == beast::websocket::error::closed ? HandshakeFailure::Closed
+                                                     : HandshakeFailure::Upgrade;
+    }
+
+    if (ec == net::error::eof ||
+        ec == net::error::connection_reset ||
+        ec == net::error::operation_aborted)
+    {
+        return HandshakeFailure::Closed;
+    }
+
+    if (ec.category() == net::error::get_netdb_category() ||
+        ec.category() == net::error::get_addrinfo_category() ||
+        ec == net::error::connection_refused ||
+        ec == net::error::host_unreachable ||
+        ec == net::error::network_unreachable)
+    {
+        return HandshakeFailure::Connect;
+    }
+
+    return HandshakeFailure::Other;
+}
+
+DisconnectReason disconnectReason(const beast::error_code& ec)
+{
+    if (!ec ||
+        ec == beast::websocket::error::closed)
+    {
+        return DisconnectReason::Normal;
+    }
+
+    if (ec == net::error::operation_aborted)
+    {
+        return DisconnectReason::Local;
+    }
+
+    if (ec == beast::error::timeout)
+    {
+        return DisconnectReason::Timeout;
+    }
+
+    return DisconnectReason::Error;
+}
+
+
+uint64_t MetricsSnapshot::failed(HandshakeFailure reason) const
+{
+    return handshakeFailures[static_cast<size_t>(reason)];
+}
+
+uint64_t MetricsSnapshot::disconnected(DisconnectReason reason) const
+{
+    return disconnects[static_cast<size_t>(reason)];
+}
+
+MetricsSnapshot& MetricsSnapshot::operator+=(const MetricsSnapshot& other)
+{
+    messagesIn += other.messagesIn;
+    bytesIn += other.bytesIn;
+    messagesOut += other.messagesOut;
+    bytesOut += other.bytesOut;
+
+    queuedMessages += other.queuedMessages;
+    queuedBytes += other.queuedBytes;
+    peakQueuedMessages = std::max(peakQueuedMessages, other.peakQueuedMessages);
+    peakQueuedBytes = std::max(peakQueuedBytes, other.peakQueuedBytes);
+
+    handshakes += other.handshakes;
+    acceptErrors += other.acceptErrors;
+
+    for (size_t i = 0; i < static_cast<size_t>(HandshakeFailure::Count); i++)
+    {
+        handshakeFailures[i] += other.handshakeFailures[i];
+    }
+
+    for (size_t i = 0; i < static_cast<size_t>(DisconnectReason::Count); i++)
+    {
+        disconnects[i] += other.disconnects[i];
+    }
+
+    queueDelay += other.queueDelay;
+    writeTime += other.writeTime;
+
+    return *this;
+}
+
+
+Metrics::Metrics()
+{
+    for (auto& counter : m_handshakeFailures)
+    {
+        counter.store(0, std::memory_order_relaxed);
+    }
+
+    for (auto& counter : m_disconnects)
+    {
+        counter.store(0, std::memory_order_relaxed);
+    }
+}
+
+void Metrics::received(size_t bytes, bool messageDone)
+{
+    m_bytesIn.fetch_add(bytes, std::memory_order_relaxed);
+
+    if (messageDone)
+    {
+        m_messagesIn.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void Metrics::sent(size_t messages, size_t bytes)
+{
+    m_messagesOut.fetch_add(messages, std::memory_order_relaxed);
+    m_bytesOut.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+void Metrics::written(std::chrono::microseconds queueDelay, std::chrono::microseconds writeTime)
+{
+    m_queueDelay.record(queueDelay);
+    m_writeTime.record(writeTime);
+}
+
+void Metrics::handshakeSucceeded()
+{
+    m_handshakes.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Metrics::handshakeFailed(HandshakeFailure reason)
+{
+    m_handshakeFailures[static_cast<size_t>(reason)].fetch_add(1, std::memory_order_relaxed);
+}
+
+void Metrics::acceptFailed()
+{
+    m_acceptErrors.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Metrics::disconnected(DisconnectReason reason)
+{
+    m_disconnects[static_cast<size_t>(reason)].fetch_add(1, std::memory_order_relaxed);
+}
+
+void Metrics::add(const MetricsSnapshot& snapshot)
+{
+    m_messagesIn.fetch_add(snapshot.messagesIn, std::memory_order_relaxed);
+    m_bytesIn.fetch_add(snapshot.bytesIn, std::memory_order_relaxed);
+    m_messagesOut.fetch_add(snapshot.messagesOut, std::memory_order_relaxed);
+    m_bytesOut.fetch_add(snapshot.bytesOut, std::memory_order_relaxed);
+
+    updatePeak(m_peakQueuedMessages, snapshot.peakQueuedMessages);
+    updatePeak(m_peakQueuedBytes, snapshot.peakQueuedBytes);
+
+    m_handshakes.fetch_add(snapshot.handshakes, std::memory_order_relaxed);
+    m_acceptErrors.fetch_add(snapshot.acceptErrors, std::memory_order_relaxed);
+
+    for (size_t i = 0; i < static_cast<size_t>(HandshakeFailure::Count); i++)
+    {
+        m_handshakeFailures[i].fetch_add(snapshot.handshakeFailures[i], std::memory_order_relaxed);
+    }
+
+    for (size_t i = 0; i < static_cast<size_t>(DisconnectReason::Count); i++)
+    {
+        m_disconnects[i].fetch_add(snapshot.disconnects[i], std::memory_order_relaxed);
+    }
+
+    m_queueDelay.add(snapshot.queueDelay);
+    m_writeTime.add(snapshot.writeTime);
+}
+
+MetricsSnapshot Metrics::snapshot() const
+{
+    MetricsSnapshot snapshot;
+
+    snapshot.messagesIn = m_messagesIn.load(std::memory_order_relaxed);
+    snapshot.bytesIn = m_bytesIn.load(std::memory_order_relaxed);
+    snapshot.messagesOut = m_messagesOut.load(std::memory_order_relaxed);
+    snapshot.bytesOut = m_bytesOut.load(std::memory_order_relaxed);
+    snapshot.peakQueuedMessages = m_peakQueuedMessages.load(std::memory_order_relaxed);
+    snapshot.peakQueuedBytes = m_peakQueuedBytes.load(std::memory_order_relaxed);
+    snapshot.handshakes = m_handshakes.load(std::memory_order_relaxed);
+    snapshot.acceptErrors = m_acceptErrors.load(std::memory_order_relaxed);
+
+    for (size_t i = 0; i < static_cast<size_t>(HandshakeFailure::Count); i++)
+    {
+        snapshot.handshakeFailures[i] = m_handshakeFailures[i].load(std::memory_order_relaxed);
+    }
+
+    for (size_t i = 0; i < static_cast<size_t>(DisconnectReason::Count); i++)
+    {
+        snapshot.disconnects[i] = m_disconnects[i].load(std::memory_order_relaxed);
+    }
+
+    snapshot.queueDelay = m_queueDelay.snapshot();
+    snapshot.writeTime = m_writeTime.snapshot();
+
+    return snapshot;
+}
+
+
+void updatePeak(std::atomic<uint64_t>& peak, uint64_t value)
+{
+    uint64_t current = peak.load(std::memory_order_relaxed);
+
+    while (value > current &&
+           !peak.compare_exchange_weak(current, value, std::memory_order_relaxed))
+    {
+    }
+}
+
+} // namespace scaryws
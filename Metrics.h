@@ -0,0 +1,134 @@
+/* A websocket server and client using Boost.Beast
+ *
+ * (C) Copyright Ingo Randolf 2025.
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See
+ * accompanying file LICENSE or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ *
+ */
+
+#ifndef SCARYWS_METRICS_H
+#define SCARYWS_METRICS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#include <boost/beast/core/error.hpp>
+
+#include "Histogram.h"
+
+namespace beast = boost::beast;
+
+namespace scaryws
+{
+
+// why a handshake failed
+enum class HandshakeFailure
+{
+    Timeout,
+    // the host could not be resolved or connected
+    Connect,
+    Tls,
+    // invalid http request or response
+    Http,
+    // the websocket upgrade was rejected
+    Upgrade,
+    // the connection closed during the handshake
+    Closed,
+    Other,
+    Count
+};
+
+// why an open connection ended
+enum class DisconnectReason
+{
+    // the peer sent a close frame
+    Normal,
+    // closed by this side
+    Local,
+    Timeout,
+    // the connection failed without a close frame
+    Error,
+    Count
+};
+
+HandshakeFailure handshakeFailure(const beast::error_code& ec);
+DisconnectReason disconnectReason(const beast::error_code& ec);
+
+// the counters of a session, a listener, a server or a client
+struct MetricsSnapshot
+{
+    uint64_t messagesIn{0};
+    uint64_t bytesIn{0};
+    uint64_t messagesOut{0};
+    uint64_t bytesOut{0};
+
+    // send queue
+    // summed over sessions, the peaks are the largest queue of a session
+    uint64_t queuedMessages{0};
+    uint64_t queuedBytes{0};
+    uint64_t peakQueuedMessages{0};
+    uint64_t peakQueuedBytes{0};
+
+    uint64_t handshakes{0};
+    uint64_t handshakeFailures[static_cast<size_t>(HandshakeFailure::Count)] = {};
+    uint64_t acceptErrors{0};
+    uint64_t disconnects[static_cast<size_t>(DisconnectReason::Count)] = {};
+
+    // of every written message: the time from send until its write
+    // started, and the time the write took
+    LatencySnapshot queueDelay;
+    LatencySnapshot writeTime;
+
+    uint64_t failed(HandshakeFailure reason) const;
+    uint64_t disconnected(DisconnectReason reason) const;
+
+    MetricsSnapshot& operator+=(const MetricsSnapshot& other);
+};
+
+// counters which are cheap enough to be always on
+// updated without locking, a snapshot can be taken from any thread.
+// the counters of a snapshot are not taken at the same instant.
+class Metrics
+{
+public:
+    Metrics();
+
+    void received(size_t bytes, bool messageDone);
+    void sent(size_t messages, size_t bytes);
+    void written(std::chrono::microseconds queueDelay, std::chrono::microseconds writeTime);
+    void handshakeSucceeded();
+    void handshakeFailed(HandshakeFailure reason);
+    void acceptFailed();
+    void disconnected(DisconnectReason reason);
+
+    // add the counters of an ended session
+    // its queue is gone, only the peaks are kept
+    void add(const MetricsSnapshot& snapshot);
+
+    MetricsSnapshot snapshot() const;
+
+private:
+    std::atomic<uint64_t> m_messagesIn{0};
+    std::atomic<uint64_t> m_bytesIn{0};
+    std::atomic<uint64_t> m_messagesOut{0};
+    std::atomic<uint64_t> m_bytesOut{0};
+    std::atomic<uint64_t> m_peakQueuedMessages{0};
+    std::atomic<uint64_t> m_peakQueuedBytes{0};
+    std::atomic<uint64_t> m_handshakes{0};
+    std::atomic<uint64_t> m_handshakeFailures[static_cast<size_t>(HandshakeFailure::Count)];
+    std::atomic<uint64_t> m_acceptErrors{0};
+    std::atomic<uint64_t> m_disconnects[static_cast<size_t>(DisconnectReason::Count)];
+    LatencyHistogram m_queueDelay;
+    LatencyHistogram m_writeTime;
+};
+
+// raise peak to value
+void updatePeak(std::atomic<uint64_t>& peak, uint64_t value);
+
+} // namespace scaryws
+
+#endif // SCARYWS_METRICS_H
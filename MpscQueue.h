@@ -0,0 +1,124 @@
+/* A websocket server and client using Boost.Beast
+ *
+ * (C) Copyright Ingo Randolf 2025.
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See
+ * accompanying file LICENSE or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ *
+ */
+
+#ifndef SCARYWS_MPSC_QUEUE_H
+#define SCARYWS_MPSC_QUEUE_H
+
+#include <atomic>
+#include <utility>
+
+namespace scaryws
+{
+
+// unbounded lock-free multi-producer single-consumer queue
+// (Dmitry Vyukov's intrusive node based queue)
+//
+// push can be called from any thread, pop only from one consumer at a time.
+// push is wait-free. pop can transiently report an empty queue while a
+// concurrent push is not finished, the consumer has to try again later.
+template<class T>
+class MpscQueue
+{
+public:
+    MpscQueue()
+        : m_head(&m_stub)
+        , m_tail(&m_stub)
+    {}
+
+    ~MpscQueue()
+    {
+        T value;
+        while (pop(value))
+        {
+        }
+    }
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    void push(T value)
+    {
+        enqueue(new Node(std::move(value)));
+    }
+
+    bool pop(T& value)
+    {
+        Node* tail = m_tail;
+        Node* next = tail->next.load(std::memory_order_acquire);
+
+        if (tail == &m_stub)
+        {
+            if (next == nullptr)
+            {
+                return false;
+            }
+
+            m_tail = next;
+            tail = next;
+            next = next->next.load(std::memory_order_acquire);
+        }
+
+        if (next == nullptr)
+        {
+            if (tail != m_head.load(std::memory_order_acquire))
+            {
+                // a push is in progress
+                return false;
+            }
+
+            // tail is the last node, put the stub behind it
+            enqueue(&m_stub);
+            next = tail->next.load(std::memory_order_acquire);
+
+            if (next == nullptr)
+            {
+                return false;
+            }
+        }
+
+        m_tail = next;
+
+        value = std::move(tail->value);
+        delete tail;
+
+        return true;
+    }
+
+private:
+    struct Node
+    {
+        Node() = default;
+
+        explicit Node(T&& v)
+            : value(std::move(v))
+        {}
+
+        std::atomic<Node*> next{nullptr};
+        T value;
+    };
+
+    void enqueue(Node* node)
+    {
+        node->next.store(nullptr, std::memory_order_relaxed);
+        Node* prev = m_head.exchange(node, std::memory_order_acq_rel);
+        prev->next.store(node, std::memory_order_release);
+    }
+
+private:
+    Node m_stub;
+
+    // producers and consumer on separate cache lines
+    alignas(64) std::atomic<Node*> m_head;
+    alignas(64) Node* m_tail;
+};
+
+} // namespace scaryws
+
+#endif // SCARYWS_MPSC_QUEUE_H
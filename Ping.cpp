@@ -0,0 +1,79 @@
+/* A websocket server and client using Boost.Beast
+ *
+ * (C) Copyright Ingo Randolf 2025.
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See
+ * accompanying file LICENSE or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ *
+ */
+
+#include "Ping.h"
+
+#include <string>
+
+namespace scaryws
+{
+
+websocket::ping_data RttMeter::ping(std::chrono::microseconds& pending)
+{
+    const auto now = std::chrono::steady_clock::now();
+
+    pending = m_pending ? std::chrono::duration_cast<std::chrono::microseconds>(now - m_sent)
+                        : std::chrono::microseconds(0);
+
+    // the sequence number tells our pongs from others,
+    // e.g. answers to the keep-alive pings of the websocket stream
+    m_sequence++;
+    m_sent = now;
+    m_pending = true;
+
+    const std::string payload = "rtt" + std::to_string(m_sequence);
+
+    return websocket::ping_data(payload.data(), payload.size());
+}
+
+bool RttMeter::pong(beast::string_view payload, std::chrono::microseconds& rtt)
+{
+    const std::string expected = "rtt" + std::to_string(m_sequence);
+
+    if (!m_pending ||
+        payload != beast::string_view(expected))
+    {
+        return false;
+    }
+
+    m_pending = false;
+    rtt = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - m_sent);
+
+    const int64_t sample = rtt.count();
+    const uint64_t samples = m_samples.load(std::memory_order_relaxed);
+    const int64_t min = m_min.load(std::memory_order_relaxed);
+    const int64_t average = m_average.load(std::memory_order_relaxed);
+
+    m_last.store(sample, std::memory_order_relaxed);
+    m_min.store(samples == 0 || sample < min ? sample : min, std::memory_order_relaxed);
+    m_average.store(samples == 0 ? sample : average + (sample - average) / 8, std::memory_order_relaxed);
+    m_samples.store(samples + 1, std::memory_order_relaxed);
+
+    return true;
+}
+
+RoundTripTime RttMeter::get() const
+{
+    RoundTripTime rtt;
+
+    rtt.last = std::chrono::microseconds(m_last.load(std::memory_order_relaxed));
+    rtt.min = std::chrono::microseconds(m_min.load(std::memory_order_relaxed));
+    rtt.average = std::chrono::microseconds(m_average.load(std::memory_order_relaxed));
+    rtt.samples = m_samples.load(std::memory_order_relaxed);
+
+    return rtt;
+}
+
+void RttMeter::reset()
+{
+    m_pending = false;
+}
+
+} // namespace scaryws
@@ -0,0 +1,77 @@
+/* A websocket server and client using Boost.Beast
+ *
+ * (C) Copyright Ingo Randolf 2025.
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See
+ * accompanying file LICENSE or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ *
+ */
+
+#ifndef SCARYWS_PING_H
+#define SCARYWS_PING_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#include <boost/beast/core/string.hpp>
+#include <boost/beast/websocket/rfc6455.hpp>
+
+namespace beast = boost::beast;
+namespace websocket = beast::websocket;
+
+namespace scaryws
+{
+
+// ping the peer every interval to measure the round trip time
+// rttExceeded is called for a round trip longer than threshold,
+// and for a ping which is not answered within threshold. 0 is off.
+struct PingOptions
+{
+    bool enabled{false};
+    std::chrono::milliseconds interval{5000};
+    std::chrono::milliseconds threshold{0};
+};
+
+// round trip times of a session, 0 until the first pong
+struct RoundTripTime
+{
+    std::chrono::microseconds last{0};
+    std::chrono::microseconds min{0};
+    // weighted moving average, every sample counts 1/8
+    std::chrono::microseconds average{0};
+    uint64_t samples{0};
+};
+
+// measures the round trip time of pings
+// used on the session strand, get can be called from any thread
+class RttMeter
+{
+public:
+    // the payload of the next ping
+    // pending is set to the age of the last ping if it is not answered
+    websocket::ping_data ping(std::chrono::microseconds& pending);
+
+    // returns true if payload answers the last ping, rtt is its round trip
+    bool pong(beast::string_view payload, std::chrono::microseconds& rtt);
+
+    RoundTripTime get() const;
+
+    // forget the unanswered ping of a lost connection
+    void reset();
+
+private:
+    std::chrono::steady_clock::time_point m_sent;
+    uint64_t m_sequence{0};
+    bool m_pending{false};
+
+    std::atomic<int64_t> m_last{0};
+    std::atomic<int64_t> m_min{0};
+    std::atomic<int64_t> m_average{0};
+    std::atomic<uint64_t> m_samples{0};
+};
+
+} // namespace scaryws
+
+#endif // SCARYWS_PING_H
@@ -0,0 +1,159 @@
+/* A websocket server and client using Boost.Beast
+ *
+ * (C) Copyright Ingo Randolf 2025.
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See
+ * accompanying file LICENSE or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ *
+ */
+
+#include "ReadBuffer.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace scaryws
+{
+
+size_t ReadBuffer::size() const
+{
+    return m_out - m_in;
+}
+
+size_t ReadBuffer::max_size() const
+{
+    return m_storage.max_size();
+}
+
+size_t ReadBuffer::capacity() const
+{
+    return m_storage.size();
+}
+
+ReadBuffer::const_buffers_type ReadBuffer::data() const
+{
+    return cdata();
+}
+
+ReadBuffer::const_buffers_type ReadBuffer::cdata() const
+{
+    return const_buffers_type(m_storage.data() + m_in, size());
+}
+
+ReadBuffer::mutable_buffers_type ReadBuffer::data()
+{
+    return mutable_buffers_type(m_storage.data() + m_in, size());
+}
+
+ReadBuffer::mutable_buffers_type ReadBuffer::prepare(size_t n)
+{
+    if (n > max_size() - size())
+    {
+        throw std::length_error("ReadBuffer overflow");
+    }
+
+    if (m_out + n > m_storage.size())
+    {
+        // move the readable bytes to the front
+        if (m_in > 0)
+        {
+            std::memmove(&m_storage[0], &m_storage[m_in], size());
+            m_out -= m_in;
+            m_in = 0;
+        }
+
+        if (m_out + n > m_storage.size())
+        {
+            // grow like a vector, at least doubling
+            // resize zero-fills all of the added capacity
+            m_storage.reserve(std::max(m_out + n, m_storage.size() * 2));
+            m_storage.resize(m_storage.capacity());
+        }
+    }
+
+    m_end = m_out + n;
+
+    return mutable_buffers_type(&m_storage[m_out], n);
+}
+
+void ReadBuffer::commit(size_t n)
+{
+    m_out += std::min(n, m_end - m_out);
+    m_end = m_out;
+}
+
+void ReadBuffer::consume(size_t n)
+{
+    if (n >= size())
+    {
+        m_in = 0;
+        m_out = 0;
+        m_end = 0;
+        return;
+    }
+
+    m_in += n;
+}
+
+const char* ReadBuffer::begin() const
+{
+    return m_storage.data() + m_in;
+}
+
+std::vector<char> ReadBuffer::release()
+{
+    if (m_in > 0)
+    {
+        m_storage.erase(m_storage.begin(), m_storage.begin() + m_in);
+    }
+
+    m_storage.resize(m_out - m_in);
+
+    std::vector<char> data(std::move(m_storage));
+
+    m_storage.clear();
+    m_in = 0;
+    m_out = 0;
+    m_end = 0;
+
+    return data;
+}
+
+void ReadBuffer::limits(const ReadLimits& limits)
+{
+    m_limits = limits;
+}
+
+void ReadBuffer::finish()
+{
+    const size_t message = size();
+
+    // average over about 8 messages
+    m_average = m_tracked ? m_average - m_average / 8 + message / 8
+                          : message;
+    m_tracked = true;
+
+    m_in = 0;
+    m_out = 0;
+    m_end = 0;
+
+    if (m_limits.releaseIdle)
+    {
+        std::vector<char>().swap(m_storage);
+        return;
+    }
+
+    const size_t keep = std::min(m_limits.maxKeep, m_average * 2);
+
+    // up to twice of keep stays, one doubling of prepare,
+    // messages of alternating sizes do not reallocate every time
+    if (m_storage.size() > keep * 2)
+    {
+        m_storage.resize(keep);
+        m_storage.shrink_to_fit();
+    }
+}
+
+} // namespace scaryws
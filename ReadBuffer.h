@@ -0,0 +1,93 @@
+/* A websocket server and client using Boost.Beast
+ *
+ * (C) Copyright Ingo Randolf 2025.
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See
+ * accompanying file LICENSE or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ *
+ */
+
+#ifndef SCARYWS_READ_BUFFER_H
+#define SCARYWS_READ_BUFFER_H
+
+#include <vector>
+
+#include <boost/asio/buffer.hpp>
+
+namespace net = boost::asio;
+
+namespace scaryws
+{
+
+// limits of received messages and of the read buffer
+//
+// a message larger than maxMessageSize closes the connection with close
+// code too_big. 0 is unlimited, this also applies to streaming receive.
+// after a message the buffer keeps twice the size of the recent
+// messages, but not more than maxKeep. capacity beyond twice of that,
+// e.g. after a spike, is released. with releaseIdle a session waits for
+// the next message without any buffer, this costs one more read per
+// message.
+struct ReadLimits
+{
+    size_t maxMessageSize{16 * 1024 * 1024};
+    size_t maxKeep{64 * 1024};
+    bool releaseIdle{false};
+};
+
+// dynamic buffer for received messages
+// like beast::flat_buffer, but the storage is a std::vector<char>
+// which can be moved out without copying the message.
+//
+// the storage is kept between messages as ReadLimits allow,
+// after release the next message allocates new storage.
+class ReadBuffer
+{
+public:
+    using const_buffers_type = net::const_buffer;
+    using mutable_buffers_type = net::mutable_buffer;
+
+    // DynamicBuffer
+    size_t size() const;
+    size_t max_size() const;
+    size_t capacity() const;
+
+    const_buffers_type data() const;
+    const_buffers_type cdata() const;
+    mutable_buffers_type data();
+
+    mutable_buffers_type prepare(size_t n);
+    void commit(size_t n);
+    void consume(size_t n);
+
+    // the readable bytes
+    const char* begin() const;
+
+    // move the readable bytes out and leave the buffer empty
+    std::vector<char> release();
+
+    // set limits before the buffer is used
+    void limits(const ReadLimits& limits);
+
+    // the message in the buffer is handled
+    // empties the buffer and releases the capacity which is not kept
+    void finish();
+
+private:
+    std::vector<char> m_storage;
+
+    // readable: [m_in, m_out), writable: [m_out, m_end)
+    size_t m_in{0};
+    size_t m_out{0};
+    size_t m_end{0};
+
+    ReadLimits m_limits;
+    // recent message size
+    size_t m_average{0};
+    bool m_tracked{false};
+};
+
+} // namespace scaryws
+
+#endif // SCARYWS_READ_BUFFER_H
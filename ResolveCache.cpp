@@ -0,0 +1,102 @@
+/* A websocket client using Boost.Beast
+ *
+ * (C) Copyright Ingo Randolf 2025.
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See
+ * accompanying file LICENSE or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ *
+ */
+
+#include "ResolveCache.h"
+
+namespace scaryws
+{
+
+// a failed resolve does not store, the next caller refreshes after this
+static const std::chrono::seconds RefreshTimeout(10);
+
+static std::string cacheKey(const std::string& host, const std::string& port)
+{
+    return host + ":" + port;
+}
+
+ResolveCache::ResolveCache(std::chrono::seconds ttl)
+    : m_ttl(ttl)
+{
+}
+
+std::shared_ptr<ResolveCache> ResolveCache::shared()
+{
+    static const std::shared_ptr<ResolveCache> cache = std::make_shared<ResolveCache>();
+    return cache;
+}
+
+void ResolveCache::ttl(std::chrono::seconds ttl)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_ttl = ttl;
+}
+
+std::chrono::seconds ResolveCache::ttl() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_ttl;
+}
+
+bool ResolveCache::find(const std::string& host, const std::string& port, std::vector<tcp::endpoint>& endpoints, bool& refresh)
+{
+    refresh = false;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto it = m_entries.find(cacheKey(host, port));
+
+    if (it == m_entries.end())
+    {
+        return false;
+    }
+
+    Entry& entry = it->second;
+    const auto now = std::chrono::steady_clock::now();
+
+    // expired, one caller resolves again
+    if (entry.expires <= now &&
+        entry.refreshing <= now)
+    {
+        entry.refreshing = now + RefreshTimeout;
+        refresh = true;
+    }
+
+    endpoints = entry.endpoints;
+    return true;
+}
+
+void ResolveCache::store(const std::string& host, const std::string& port, const std::vector<tcp::endpoint>& endpoints)
+{
+    if (endpoints.empty())
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    Entry& entry = m_entries[cacheKey(host, port)];
+    entry.endpoints = endpoints;
+    entry.expires = std::chrono::steady_clock::now() + m_ttl;
+    entry.refreshing = std::chrono::steady_clock::time_point();
+}
+
+void ResolveCache::remove(const std::string& host, const std::string& port)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries.erase(cacheKey(host, port));
+}
+
+void ResolveCache::clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries.clear();
+}
+
+} // namespace scaryws
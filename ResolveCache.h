@@ -0,0 +1,72 @@
+/* A websocket client using Boost.Beast
+ *
+ * (C) Copyright Ingo Randolf 2025.
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See
+ * accompanying file LICENSE or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ *
+ */
+
+#ifndef SCARYWS_RESOLVE_CACHE_H
+#define SCARYWS_RESOLVE_CACHE_H
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <boost/asio/ip/tcp.hpp>
+
+namespace net = boost::asio;            // from <boost/asio.hpp>
+using tcp = boost::asio::ip::tcp;       // from <boost/asio/ip/tcp.hpp>
+
+namespace scaryws
+{
+
+// resolved endpoints per host and port, shared by client sessions
+//
+// entries expire after ttl. the next connection attempt resolves the
+// host again, while it does other sessions get the expired endpoints,
+// so a reconnect storm resolves a host once. sessions remove an entry
+// if none of its endpoints could be connected.
+class ResolveCache
+{
+public:
+    explicit ResolveCache(std::chrono::seconds ttl = std::chrono::seconds(30));
+
+    // one process-wide cache
+    static std::shared_ptr<ResolveCache> shared();
+
+    // takes effect for new entries
+    void ttl(std::chrono::seconds ttl);
+    std::chrono::seconds ttl() const;
+
+    // returns false if there is no entry
+    // refresh is set if the entry expired and the caller has to resolve
+    // the host again. it is set for one caller at a time, a refresh not
+    // stored within 10 seconds is handed to the next caller
+    bool find(const std::string& host, const std::string& port, std::vector<tcp::endpoint>& endpoints, bool& refresh);
+    void store(const std::string& host, const std::string& port, const std::vector<tcp::endpoint>& endpoints);
+    void remove(const std::string& host, const std::string& port);
+    void clear();
+
+private:
+    struct Entry
+    {
+        std::vector<tcp::endpoint> endpoints;
+        std::chrono::steady_clock::time_point expires;
+        // a caller resolves the host until then
+        std::chrono::steady_clock::time_point refreshing;
+    };
+
+    mutable std::mutex m_mutex;
+    std::chrono::seconds m_ttl;
+    std::unordered_map<std::string, Entry> m_entries;
+};
+
+} // namespace scaryws
+
+#endif // SCARYWS_RESOLVE_CACHE_H
@@ -0,0 +1,233 @@
+/* A websocket server and client using Boost.Beast
+ *
+ * (C) Copyright Ingo Randolf 2025.
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See
+ * accompanying file LICENSE or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ *
+ */
+
+#include "SendQueue.h"
+
+namespace scaryws
+{
+
+size_t OutgoingMessage::size() const
+{
+    return header.size() + payload.size();
+}
+
+
+void SendQueue::limits(const SendQueueLimits& limits)
+{
+    m_limits = limits;
+}
+
+SendQueueLimits SendQueue::limits() const
+{
+    return m_limits;
+}
+
+SendResult SendQueue::push(OutgoingMessage message, bool& start)
+{
+    start = false;
+
+    const size_t size = message.size();
+    bool trim = false;
+
+    if (!fits(size))
+    {
+        switch (m_limits.policy)
+        {
+        case OverflowPolicy::Reject:
+            return SendResult::Rejected;
+
+        case OverflowPolicy::DropNewest:
+            return SendResult::Dropped;
+
+        case OverflowPolicy::Disconnect:
+            return SendResult::Disconnected;
+
+        case OverflowPolicy::DropOldest:
+            // the consumer drops old messages
+            // a message larger than the limit can never fit
+            if (m_limits.maxBytes > 0 &&
+                size > m_limits.maxBytes)
+            {
+                return SendResult::Dropped;
+            }
+
+            // run the consumer, also while it is writing
+            trim = !m_trimPending.exchange(true, std::memory_order_acq_rel);
+            break;
+        }
+    }
+
+    updatePeak(m_peakBytes, m_bytes.fetch_add(size, std::memory_order_relaxed) + size);
+
+    message.queued = std::chrono::steady_clock::now();
+    m_incoming.push(std::move(message));
+
+    // the sender which makes the queue non-empty starts the consumer
+    const size_t queued = m_size.fetch_add(1, std::memory_order_acq_rel);
+    start = queued == 0 || trim;
+
+    updatePeak(m_peakSize, queued + 1);
+
+    return SendResult::Queued;
+}
+
+bool SendQueue::front(OutgoingMessage& message)
+{
+    collect();
+
+    if (m_writing > 0 ||
+        m_ready.empty())
+    {
+        return false;
+    }
+
+    m_writing = 1;
+    message = m_ready.front();
+
+    return true;
+}
+
+size_t SendQueue::front(std::vector<OutgoingMessage>& messages, size_t maxBytes)
+{
+    messages.clear();
+
+    collect();
+
+    if (m_writing > 0)
+    {
+        return 0;
+    }
+
+    size_t bytes = 0;
+
+    for (auto& message : m_ready)
+    {
+        if (!messages.empty() &&
+            (message.producer || bytes + message.size() > maxBytes))
+        {
+            break;
+        }
+
+        bytes += message.size();
+        messages.push_back(message);
+
+        if (message.producer)
+        {
+            break;
+        }
+    }
+
+    m_writing = messages.size();
+
+    return m_writing;
+}
+
+bool SendQueue::pop()
+{
+    const size_t count = m_writing;
+
+    for (; m_writing > 0 && !m_ready.empty(); m_writing--)
+    {
+        m_bytes.fetch_sub(m_ready.front().size(), std::memory_order_relaxed);
+        m_ready.pop_front();
+    }
+
+    m_writing = 0;
+
+    return m_size.fetch_sub(count, std::memory_order_acq_rel) > count;
+}
+
+void SendQueue::rewind()
+{
+    m_writing = 0;
+}
+
+bool SendQueue::stalled() const
+{
+    return m_writing == 0 &&
+            m_ready.empty() &&
+            m_size.load(std::memory_order_acquire) > 0;
+}
+
+size_t SendQueue::size() const
+{
+    return m_size.load(std::memory_order_relaxed);
+}
+
+size_t SendQueue::bytes() const
+{
+    return m_bytes.load(std::memory_order_relaxed);
+}
+
+size_t SendQueue::peakSize() const
+{
+    return static_cast<size_t>(m_peakSize.load(std::memory_order_relaxed));
+}
+
+size_t SendQueue::peakBytes() const
+{
+    return static_cast<size_t>(m_peakBytes.load(std::memory_order_relaxed));
+}
+
+bool SendQueue::fits(size_t size) const
+{
+    if (m_limits.maxMessages > 0 &&
+        m_size.load(std::memory_order_relaxed) + 1 > m_limits.maxMessages)
+    {
+        return false;
+    }
+
+    if (m_limits.maxBytes > 0 &&
+        m_bytes.load(std::memory_order_relaxed) + size > m_limits.maxBytes)
+    {
+        return false;
+    }
+
+    return true;
+}
+
+void SendQueue::collect()
+{
+    OutgoingMessage message;
+
+    while (m_incoming.pop(message))
+    {
+        m_ready.push_back(std::move(message));
+    }
+
+    if (m_limits.policy != OverflowPolicy::DropOldest)
+    {
+        return;
+    }
+
+    m_trimPending.store(false, std::memory_order_release);
+
+    // drop the oldest messages which are not written
+    // the newest message always stays
+    size_t dropped = 0;
+
+    while (m_ready.size() > m_writing + 1 &&
+           ((m_limits.maxMessages > 0 && m_size.load(std::memory_order_relaxed) - dropped > m_limits.maxMessages) ||
+            (m_limits.maxBytes > 0 && m_bytes.load(std::memory_order_relaxed) > m_limits.maxBytes)))
+    {
+        auto it = m_ready.begin() + m_writing;
+        m_bytes.fetch_sub(it->size(), std::memory_order_relaxed);
+        m_ready.erase(it);
+        dropped++;
+    }
+
+    if (dropped > 0)
+    {
+        // the queue stays non-empty, the consumer keeps running
+        m_size.fetch_sub(dropped, std::memory_order_acq_rel);
+    }
+}
+
+} // namespace scaryws
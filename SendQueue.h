@@ -0,0 +1,173 @@
+/* A websocket server and client using Boost.Beast
+ *
+ * (C) Copyright Ingo Randolf 2025.
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See
+ * accompanying file LICENSE or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ *
+ */
+
+#ifndef SCARYWS_SEND_QUEUE_H
+#define SCARYWS_SEND_QUEUE_H
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include "ChunkSource.h"
+#include "Compression.h"
+#include "Frame.h"
+#include "Metrics.h"
+#include "MpscQueue.h"
+#include "SharedBuffer.h"
+
+namespace scaryws
+{
+
+// what happens to a message if the send queue is full
+enum class OverflowPolicy
+{
+    // do not queue the message, send returns Rejected
+    Reject,
+    // drop the oldest queued message to make room
+    DropOldest,
+    // drop the new message, send returns Dropped
+    DropNewest,
+    // close the connection, send returns Disconnected
+    Disconnect
+};
+
+enum class SendResult
+{
+    Queued,
+    Rejected,
+    Dropped,
+    Disconnected,
+    NotConnected
+};
+
+// limits of a session send queue
+// 0 is unlimited
+struct SendQueueLimits
+{
+    size_t maxMessages{0};
+    size_t maxBytes{0};
+    OverflowPolicy policy{OverflowPolicy::Reject};
+};
+
+// write several queued messages with one write
+// messages are encoded as frames and written together, up to maxBytes.
+// with a flushDelay a session waits this long after the first message
+// of a burst before writing, so more messages can be collected.
+struct WriteCoalescing
+{
+    bool enabled{false};
+    size_t maxBytes{64 * 1024};
+    std::chrono::microseconds flushDelay{0};
+};
+
+struct OutgoingMessage
+{
+    SharedBuffer payload;
+
+    // set for pre-encoded frames
+    FrameHeader header;
+
+    CompressionMode compression{CompressionMode::Auto};
+
+    // set for streamed messages, the payload is empty
+    // they are written alone, one fragment per chunk
+    std::shared_ptr<ChunkProducer> producer;
+
+    // set by the queue when the message is pushed
+    std::chrono::steady_clock::time_point queued;
+
+    // streamed messages count as 0 bytes
+    size_t size() const;
+};
+
+// a consumer finding the queue stalled tries again after this delay,
+// the unfinished send can be on a preempted thread
+const std::chrono::microseconds StalledRetryDelay{50};
+
+// the outgoing messages of a session
+//
+// messages are pushed from any thread without locking.
+// the session is the only consumer and drains the queue on its strand:
+// front, write, pop.
+//
+// limits are checked without locking as well. with concurrent senders
+// the queue can exceed its limits by the number of these senders.
+class SendQueue
+{
+public:
+    // set limits before the session is used
+    void limits(const SendQueueLimits& limits);
+    SendQueueLimits limits() const;
+
+    // start is set if the caller has to run the consumer:
+    // the queue was idle, or old messages have to be dropped
+    SendResult push(OutgoingMessage message, bool& start);
+
+    // consumer
+
+    // get the next message to write
+    // it stays in the queue until pop is called
+    // returns false if the queue is empty or a message is being written
+    // drops old messages with OverflowPolicy::DropOldest
+    bool front(OutgoingMessage& message);
+
+    // get messages to write at once, at least one and up to maxBytes
+    // a streamed message is returned alone
+    // they stay in the queue until pop is called
+    // returns the number of messages
+    size_t front(std::vector<OutgoingMessage>& messages, size_t maxBytes);
+
+    // remove the written messages
+    // returns true if more messages are queued
+    bool pop();
+
+    // the write of the messages from front did not complete
+    // they are returned again by the next front
+    void rewind();
+
+    // messages are queued, but a concurrent push is not finished yet
+    // try front again later
+    bool stalled() const;
+
+    // any thread
+
+    size_t size() const;
+    size_t bytes() const;
+
+    // the largest size of the queue
+    size_t peakSize() const;
+    size_t peakBytes() const;
+
+private:
+    bool fits(size_t size) const;
+    void collect();
+
+private:
+    MpscQueue<OutgoingMessage> m_incoming;
+
+    std::atomic<size_t> m_size{0};
+    std::atomic<size_t> m_bytes{0};
+    std::atomic<bool> m_trimPending{false};
+
+    std::atomic<uint64_t> m_peakSize{0};
+    std::atomic<uint64_t> m_peakBytes{0};
+
+    // only used by the consumer
+    std::deque<OutgoingMessage> m_ready;
+    size_t m_writing{0};
+
+    SendQueueLimits m_limits;
+};
+
+} // namespace scaryws
+
+#endif // SCARYWS_SEND_QUEUE_H
@@ -12,12 +12,102 @@
 
 #include <iostream>
 
+#ifdef SCARYWS_HAS_LOCAL_LISTENER
+#include <cerrno>
+
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 namespace scaryws
 {
 
-ServerListener::ServerListener(net::io_context& ioc, tcp::endpoint endpoint, bool binary)
+#ifdef SCARYWS_HAS_LOCAL_LISTENER
+// remove a socket file left at path, e.g. by a previous run
+// anything else at path is kept and reported as file_exists
+static void removeSocketFile(const std::string& path, beast::error_code& ec)
+{
+    struct stat status;
+
+    if (::lstat(path.c_str(), &status) != 0)
+    {
+        if (errno != ENOENT)
+        {
+            ec.assign(errno, beast::system_category());
+        }
+        return;
+    }
+
+    if (!S_ISSOCK(status.st_mode))
+    {
+        ec = make_error_code(boost::system::errc::file_exists);
+        return;
+    }
+
+    if (::unlink(path.c_str()) != 0)
+    {
+        ec.assign(errno, beast::system_category());
+    }
+}
+#endif
+
+// window bits of permessage-deflate
+static const int MinWindowBits = 8;
+static const int MaxWindowBits = 15;
+
+// 0 if the session has no shared compression,
+// values out of range are not trusted as an index
+static bool sharedWindowBits(int bits)
+{
+    return bits >= MinWindowBits &&
+            bits <= MaxWindowBits;
+}
+
+#ifdef SO_REUSEPORT
+// SO_REUSEPORT as a SettableSocketOption of asio
+class ReusePort
+{
+public:
+    explicit ReusePort(bool enabled)
+        : m_value(enabled ? 1 : 0)
+    {
+    }
+
+    template<class Protocol>
+    int level(const Protocol&) const
+    {
+        return SOL_SOCKET;
+    }
+
+    template<class Protocol>
+    int name(const Protocol&) const
+    {
+        return SO_REUSEPORT;
+    }
+
+    template<class Protocol>
+    const int* data(const Protocol&) const
+    {
+        return &m_value;
+    }
+
+    template<class Protocol>
+    size_t size(const Protocol&) const
+    {
+        return sizeof(m_value);
+    }
+
+private:
+    int m_value;
+};
+#endif
+
+ServerListener::ServerListener(net::io_context& ioc, tcp::endpoint endpoint, bool binary, bool reusePort)
     : m_ioc(ioc)
     , m_acceptor(net::make_strand(ioc))
+#ifdef SCARYWS_HAS_LOCAL_LISTENER
+    , m_localAcceptor(m_acceptor.get_executor())
+#endif
     , m_binary(binary)
 {
     beast::error_code ec;
@@ -36,6 +126,20 @@ ServerListener::ServerListener(net::io_context& ioc, tcp::endpoint endpoint, boo
         return;
     }
 
+    if (reusePort)
+    {
+#ifdef SO_REUSEPORT
+        m_acceptor.set_option(ReusePort(true), ec);
+#else
+        ec = net::error::operation_not_supported;
+#endif
+        if (ec)
+        {
+            fail(ec, "acceptor set_option reuse_port");
+            return;
+        }
+    }
+
     m_acceptor.bind(endpoint, ec);
     if (ec)
     {
@@ -51,6 +155,71 @@ ServerListener::ServerListener(net::io_context& ioc, tcp::endpoint endpoint, boo
     }
 }
 
+ServerListener::ServerListener(net::io_context& ioc, const std::string& path, bool binary)
+    : m_ioc(ioc)
+    , m_acceptor(net::make_strand(ioc))
+#ifdef SCARYWS_HAS_LOCAL_LISTENER
+    , m_localAcceptor(m_acceptor.get_executor())
+#endif
+    , m_localPath(path)
+    , m_binary(binary)
+{
+#ifndef SCARYWS_HAS_LOCAL_LISTENER
+    fail(net::error::operation_not_supported, "local acceptor");
+#else
+    beast::error_code ec;
+
+    // a socket file left over from a previous run
+    removeSocketFile(m_localPath, ec);
+    if (ec)
+    {
+        fail(ec, "local acceptor path");
+        return;
+    }
+
+    const stream_protocol::endpoint endpoint(m_localPath);
+
+    m_localAcceptor.open(endpoint.protocol(), ec);
+    if (ec)
+    {
+        fail(ec, "local acceptor open");
+        return;
+    }
+
+    m_localAcceptor.bind(endpoint, ec);
+    if (ec)
+    {
+        fail(ec, "local acceptor bind");
+        return;
+    }
+
+    m_localAcceptor.listen(net::socket_base::max_listen_connections, ec);
+    if (ec)
+    {
+        fail(ec, "local acceptor listen");
+        return;
+    }
+#endif
+}
+
+bool ServerListener::reusePortSupported()
+{
+#ifdef SO_REUSEPORT
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool ServerListener::localSupported()
+{
+#ifdef SCARYWS_HAS_LOCAL_LISTENER
+    return true;
+#else
+    return false;
+#endif
+}
+
 void ServerListener::run()
 {
     do_accept();
@@ -61,88 +230,309 @@ void ServerListener::setListener(IServerSessionListener* listener)
     m_listener = listener;
 }
 
+void ServerListener::preEncodedBroadcast(bool preEncoded)
+{
+    m_preEncodedBroadcast = preEncoded;
+}
+
+void ServerListener::sendQueueLimits(const SendQueueLimits& limits)
+{
+    m_sendQueueLimits = limits;
+}
+
+void ServerListener::writeCoalescing(const WriteCoalescing& coalescing)
+{
+    m_writeCoalescing = coalescing;
+}
+
+void ServerListener::moveReceived(bool move)
+{
+    m_moveReceived = move;
+}
+
+void ServerListener::streamingReceive(const StreamingReceive& options)
+{
+    m_streamingReceive = options;
+}
+
+void ServerListener::readLimits(const ReadLimits& limits)
+{
+    m_readLimits = limits;
+}
+
+void ServerListener::ping(const PingOptions& options)
+{
+    m_ping = options;
+}
+
+void ServerListener::compression(const CompressionOptions& options)
+{
+    m_compression = options;
+}
+
+void ServerListener::sslContext(std::shared_ptr<ssl::context> ctx)
+{
+    m_sslContext = ctx;
+}
+
 
 void ServerListener::cancel()
 {
     std::lock_guard<std::recursive_mutex> lock(m_mutex);
 
+    m_cancelled = true;
+
     for (auto& session : m_sessions)
     {
-        session->close();
+        session.second->close();
     }
 
-    m_acceptor.cancel();
-    m_acceptor.close();
+    // the acceptor is used on its strand
+    auto self(shared_from_this());
+    net::dispatch(m_acceptor.get_executor(), [self]
+    {
+        beast::error_code ec;
+        self->m_acceptor.cancel(ec);
+        self->m_acceptor.close(ec);
+
+#ifdef SCARYWS_HAS_LOCAL_LISTENER
+        if (self->m_localAcceptor.is_open())
+        {
+            self->m_localAcceptor.cancel(ec);
+            self->m_localAcceptor.close(ec);
+            removeSocketFile(self->m_localPath, ec);
+        }
+#endif
+    });
 }
 
-void ServerListener::sendToAll(const std::string& msg, void* except)
+void ServerListener::sendToAll(const std::string& msg, ClientId except, CompressionMode mode)
 {
-    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+    // one payload for all sessions
+    sendToAll(SharedBuffer(msg), except, mode);
+}
 
-    for (auto& session : m_sessions)
+void ServerListener::sendToAll(const std::vector<char>& data, ClientId except, CompressionMode mode)
+{
+    // one payload for all sessions
+    sendToAll(SharedBuffer(data), except, mode);
+}
+
+void ServerListener::sendToAll(std::string&& msg, ClientId except, CompressionMode mode)
+{
+    sendToAll(SharedBuffer(std::move(msg)), except, mode);
+}
+
+void ServerListener::sendToAll(std::vector<char>&& data, ClientId except, CompressionMode mode)
+{
+    sendToAll(SharedBuffer(std::move(data)), except, mode);
+}
+
+void ServerListener::sendToAll(const SharedBuffer& buffer, ClientId except, CompressionMode mode)
+{
+    if (!m_preEncodedBroadcast)
     {
-        if (session.get() != except)
+        std::lock_guard<std::recursive_mutex> lock(m_mutex);
+
+        for (auto& session : m_sessions)
         {
-            session->send(msg);
+            if (session.first != except)
+            {
+                session.second->send(buffer, mode);
+            }
+        }
+
+        return;
+    }
+
+    // frames from the server are not masked,
+    // all sessions can write the same frame
+    const FrameHeader header(m_binary, buffer.size());
+
+    // sessions without compression context get a frame compressed once
+    // for each window size in use, indexed by window bits
+    SharedBuffer deflated[MaxWindowBits + 1];
+    FrameHeader deflatedHeader[MaxWindowBits + 1];
+
+    if (m_compression.enabled &&
+        shouldCompress(mode, buffer.size(), m_compression))
+    {
+        bool windowBits[MaxWindowBits + 1] = {};
+
+        {
+            std::lock_guard<std::recursive_mutex> lock(m_mutex);
+
+            for (auto& session : m_sessions)
+            {
+                const int bits = session.second->sharedDeflateBits();
+
+                if (sharedWindowBits(bits))
+                {
+                    windowBits[bits] = true;
+                }
+            }
+        }
+
+        // compress without holding the lock
+        // zlib does not write raw deflate with 8 window bits,
+        // these sessions get the frame uncompressed
+        for (int bits = 9; bits <= MaxWindowBits; bits++)
+        {
+            if (windowBits[bits])
+            {
+                deflated[bits] = deflateMessage(buffer, bits, m_compression);
+
+                if (!deflated[bits].empty())
+                {
+                    deflatedHeader[bits] = FrameHeader(m_binary, deflated[bits].size());
+                    deflatedHeader[bits].compressed(true);
+                }
+            }
         }
     }
-}
 
-void ServerListener::sendToAll(const std::vector<char>& data, void* except)
-{
     std::lock_guard<std::recursive_mutex> lock(m_mutex);
 
     for (auto& session : m_sessions)
     {
-        if (session.get() != except)
+        if (session.first == except)
+        {
+            continue;
+        }
+
+        const int bits = session.second->sharedDeflateBits();
+
+        if (sharedWindowBits(bits) &&
+            !deflated[bits].empty())
+        {
+            session.second->sendFrame(deflatedHeader[bits], deflated[bits], mode);
+        }
+        else
         {
-            session->send(data);
+            session.second->sendFrame(header, buffer, mode);
         }
     }
 }
 
-void ServerListener::sendTo(const std::string& msg, void* client)
+SendResult ServerListener::sendTo(const std::string& msg, ClientId client, CompressionMode mode)
+{
+    return sendTo(SharedBuffer(msg), client, mode);
+}
+
+SendResult ServerListener::sendTo(const std::vector<char>& data, ClientId client, CompressionMode mode)
+{
+    return sendTo(SharedBuffer(data), client, mode);
+}
+
+SendResult ServerListener::sendTo(std::string&& msg, ClientId client, CompressionMode mode)
+{
+    return sendTo(SharedBuffer(std::move(msg)), client, mode);
+}
+
+SendResult ServerListener::sendTo(std::vector<char>&& data, ClientId client, CompressionMode mode)
+{
+    return sendTo(SharedBuffer(std::move(data)), client, mode);
+}
+
+SendResult ServerListener::sendTo(const SharedBuffer& buffer, ClientId client, CompressionMode mode)
 {
     std::lock_guard<std::recursive_mutex> lock(m_mutex);
 
-    for (auto& session : m_sessions)
+    auto it = m_sessions.find(client);
+    if (it == m_sessions.end())
     {
-        if (session.get() == client)
-        {
-            session->send(msg);
-            break;
-        }
+        return SendResult::NotConnected;
     }
+
+    return it->second->send(buffer, mode);
 }
 
-void ServerListener::sendTo(const std::vector<char>& data, void* client)
+SendResult ServerListener::sendStreamTo(ChunkProducer producer, ClientId client, CompressionMode mode)
 {
     std::lock_guard<std::recursive_mutex> lock(m_mutex);
 
-    for (auto& session : m_sessions)
+    auto it = m_sessions.find(client);
+    if (it == m_sessions.end())
     {
-        if (session.get() == client)
-        {
-            session->send(data);
-            break;
-        }
+        return SendResult::NotConnected;
     }
+
+    return it->second->sendStream(std::move(producer), mode);
 }
 
 bool ServerListener::isListening() const
 {
+#ifdef SCARYWS_HAS_LOCAL_LISTENER
+    return m_acceptor.is_open() ||
+            m_localAcceptor.is_open();
+#else
     return m_acceptor.is_open();
+#endif
 }
 
 size_t ServerListener::sessionCount() const
 {
+    std::lock_guard<std::recursive_mutex> lock(m_mutex);
     return m_sessions.size();
 }
 
+MetricsSnapshot ServerListener::metrics() const
+{
+    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+
+    MetricsSnapshot snapshot = m_metrics.snapshot();
+
+    for (auto& session : m_sessions)
+    {
+        snapshot += session.second->metrics();
+    }
+
+    return snapshot;
+}
+
+bool ServerListener::metrics(ClientId client, MetricsSnapshot& snapshot) const
+{
+    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+
+    auto it = m_sessions.find(client);
+    if (it == m_sessions.end())
+    {
+        return false;
+    }
+
+    snapshot = it->second->metrics();
+    return true;
+}
+
+bool ServerListener::roundTripTime(ClientId client, RoundTripTime& rtt) const
+{
+    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+
+    auto it = m_sessions.find(client);
+    if (it == m_sessions.end())
+    {
+        return false;
+    }
+
+    rtt = it->second->roundTripTime();
+    return true;
+}
+
 
 void ServerListener::do_accept()
 {
     // The new connection gets its own strand
+#ifdef SCARYWS_HAS_LOCAL_LISTENER
+    if (!m_localPath.empty())
+    {
+        m_localAcceptor.async_accept(
+            net::make_strand(m_ioc),
+            beast::bind_front_handler(&ServerListener::on_accept_local,
+                                      shared_from_this()));
+        return;
+    }
+#endif
+
     m_acceptor.async_accept(
         net::make_strand(m_ioc),
         beast::bind_front_handler(&ServerListener::on_accept,
@@ -167,56 +557,119 @@ void ServerListener::on_accept(beast::error_code ec,
 
     if (ec)
     {
+        m_metrics.acceptFailed();
         fail(ec, "accept");
     }
     else
     {
+        // no delay, like the client
+        // Nagle holds back the later flights of a TLS handshake
+        socket.set_option(tcp::no_delay(true), ec);
+
         // Create the session and run it
-        auto session = std::make_shared<ServerSession>(std::move(socket), m_binary);
-        session->setListener(m_listener);
-        session->run([this](ServerSession* session)
-        {
-            // closed callback
-            // remove session
-            std::lock_guard<std::recursive_mutex> lock(m_mutex);
+        std::shared_ptr<ServerSessionBase> session;
 
-            auto it = m_sessions.begin();
-            while(it != m_sessions.end())
-            {
-                if (it->get() == session)
-                {
-                    m_sessions.erase(it);
+        if (m_sslContext)
+        {
+            session = std::make_shared<ServerSessionSSL>(std::move(socket), *m_sslContext, m_binary);
+        }
+        else
+        {
+            session = std::make_shared<ServerSession>(std::move(socket), m_binary);
+        }
 
-                    if (m_listener)
-                    {
-                        m_listener->clientDisconnected(session);
-                    }
+        startSession(session);
+    }
 
-                    break;
-                }
 
-                it++;
-            }
+    // accept next
+    do_accept();
+}
 
-            if (!m_acceptor.is_open() &&
-                m_sessions.empty())
-            {
-                // all clients closed - stop the world
-                m_ioc.stop();
-            }
-        });
+#ifdef SCARYWS_HAS_LOCAL_LISTENER
+void ServerListener::on_accept_local(beast::error_code ec,
+                                     stream_protocol::socket socket)
+{
+    // This can happen during exit
+    if (!m_localAcceptor.is_open())
+    {
+        return;
+    }
 
-        // add session
-        {
-            std::lock_guard<std::recursive_mutex> lock(m_mutex);
-            m_sessions.push_back(session);
-        }
+    // This can happen during exit
+    if (ec == boost::asio::error::operation_aborted)
+    {
+        return;
     }
 
+    if (ec)
+    {
+        m_metrics.acceptFailed();
+        fail(ec, "accept");
+    }
+    else
+    {
+        startSession(std::make_shared<ServerSessionUnix>(std::move(socket), m_binary));
+    }
 
     // accept next
     do_accept();
 }
+#endif
+
+void ServerListener::startSession(std::shared_ptr<ServerSessionBase> session)
+{
+    session->setListener(m_listener);
+    session->sendQueueLimits(m_sendQueueLimits);
+    session->writeCoalescing(m_writeCoalescing);
+    session->moveReceived(m_moveReceived);
+    session->streamingReceive(m_streamingReceive);
+    session->readLimits(m_readLimits);
+    session->ping(m_ping);
+    session->compression(m_compression);
+    // add the session before it runs
+    // with more than one thread it can end before run returns
+    {
+        std::lock_guard<std::recursive_mutex> lock(m_mutex);
+        m_sessions.emplace(session->id(), session);
+    }
+
+    // sessions can outlive the listener, e.g. while the io_context
+    // runs their last handlers after the listener was removed
+    std::weak_ptr<ServerListener> weak(shared_from_this());
+
+    session->run([weak](ServerSessionBase* session)
+    {
+        // closed callback
+        auto self = weak.lock();
+        if (!self)
+        {
+            return;
+        }
+
+        // remove session
+        std::lock_guard<std::recursive_mutex> lock(self->m_mutex);
+
+        if (self->m_sessions.erase(session->id()) > 0)
+        {
+            self->m_metrics.add(session->metrics());
+
+            // a failed handshake was never reported as connected
+            if (self->m_listener &&
+                session->isOpen())
+            {
+                self->m_listener->clientDisconnected(session->id());
+            }
+        }
+
+        if (self->m_cancelled &&
+            self->m_sessions.empty())
+        {
+            // all clients closed - stop the world
+            self->m_ioc.stop();
+        }
+    });
+}
 
 void ServerListener::fail(beast::error_code ec, char const* what)
 {
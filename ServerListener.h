@@ -12,17 +12,27 @@
 #define SCARYWS_SERVER_LISTENER_H
 
 #include <memory>
+#include <string>
+#include <unordered_map>
 
 #include <boost/beast/core.hpp>
 #include <boost/asio/strand.hpp>
 
 #include "IServerSessionListener.h"
 #include "ServerSession.h"
+#include "ServerSessionSSL.h"
+#include "ServerSessionUnix.h"
+#include "SharedBuffer.h"
 
 namespace beast = boost::beast;
 namespace net = boost::asio;
 using tcp = boost::asio::ip::tcp;
 
+// ws+unix:// listeners, the socket file is handled with POSIX calls
+#if defined(BOOST_ASIO_HAS_LOCAL_SOCKETS) && !defined(_WIN32)
+#define SCARYWS_HAS_LOCAL_LISTENER
+#endif
+
 namespace scaryws
 {
 
@@ -30,32 +40,95 @@ class ServerListener
     : public std::enable_shared_from_this<ServerListener>
 {
 public:
-    ServerListener(net::io_context& ioc, tcp::endpoint endpoint, bool binary);
+    // reusePort: bind with SO_REUSEPORT, to share the endpoint with other listeners
+    ServerListener(net::io_context& ioc, tcp::endpoint endpoint, bool binary, bool reusePort = false);
+
+    // listen on a unix domain socket at path
+    // an existing socket file is replaced and removed on cancel.
+    // sessions are not encrypted
+    // fails with operation_not_supported if localSupported() is false
+    ServerListener(net::io_context& ioc, const std::string& path, bool binary);
+
+    static bool reusePortSupported();
+    static bool localSupported();
 
     void run();
     void setListener(IServerSessionListener* listener);
 
+    // encode broadcast frames once and write them to every session as they are
+    // default: false
+    void preEncodedBroadcast(bool preEncoded);
+
+    // limits for the send queue of new sessions
+    void sendQueueLimits(const SendQueueLimits& limits);
+    void writeCoalescing(const WriteCoalescing& coalescing);
+    void moveReceived(bool move);
+    void streamingReceive(const StreamingReceive& options);
+    void readLimits(const ReadLimits& limits);
+    void ping(const PingOptions& options);
+    void compression(const CompressionOptions& options);
+
+    // accept wss:// connections with this context
+    void sslContext(std::shared_ptr<ssl::context> ctx);
+
     void cancel();
-    void sendToAll(const std::string& msg, void* except = nullptr);
-    void sendToAll(const std::vector<char>& data, void* except = nullptr);
-    void sendTo(const std::string& msg, void* client);
-    void sendTo(const std::vector<char>& data, void* client);
+    void sendToAll(const std::string& msg, ClientId except = 0, CompressionMode mode = CompressionMode::Auto);
+    void sendToAll(const std::vector<char>& data, ClientId except = 0, CompressionMode mode = CompressionMode::Auto);
+    void sendToAll(std::string&& msg, ClientId except = 0, CompressionMode mode = CompressionMode::Auto);
+    void sendToAll(std::vector<char>&& data, ClientId except = 0, CompressionMode mode = CompressionMode::Auto);
+    void sendToAll(const SharedBuffer& buffer, ClientId except = 0, CompressionMode mode = CompressionMode::Auto);
+
+    // returns NotConnected if the client is not connected to this listener
+    SendResult sendTo(const std::string& msg, ClientId client, CompressionMode mode = CompressionMode::Auto);
+    SendResult sendTo(const std::vector<char>& data, ClientId client, CompressionMode mode = CompressionMode::Auto);
+    SendResult sendTo(std::string&& msg, ClientId client, CompressionMode mode = CompressionMode::Auto);
+    SendResult sendTo(std::vector<char>&& data, ClientId client, CompressionMode mode = CompressionMode::Auto);
+    SendResult sendTo(const SharedBuffer& buffer, ClientId client, CompressionMode mode = CompressionMode::Auto);
+    SendResult sendStreamTo(ChunkProducer producer, ClientId client, CompressionMode mode = CompressionMode::Auto);
 
     bool isListening() const;
     size_t sessionCount() const;
 
+    // counters of all sessions of this listener, ended ones included
+    MetricsSnapshot metrics() const;
+    // returns false if the client is not connected to this listener
+    bool metrics(ClientId client, MetricsSnapshot& snapshot) const;
+    // returns false if the client is not connected to this listener
+    bool roundTripTime(ClientId client, RoundTripTime& rtt) const;
+
 private:
     void fail(beast::error_code ec, char const* what);
     void do_accept();
     void on_accept(beast::error_code ec, tcp::socket socket);
+#ifdef SCARYWS_HAS_LOCAL_LISTENER
+    void on_accept_local(beast::error_code ec, stream_protocol::socket socket);
+#endif
+    void startSession(std::shared_ptr<ServerSessionBase> session);
 
 private:
     net::io_context& m_ioc;
     tcp::acceptor m_acceptor;
+    // unix domain socket
+#ifdef SCARYWS_HAS_LOCAL_LISTENER
+    stream_protocol::acceptor m_localAcceptor;
+#endif
+    std::string m_localPath;
 
     mutable std::recursive_mutex m_mutex;
-    std::vector<std::shared_ptr<ServerSession>> m_sessions;
+    std::unordered_map<ClientId, std::shared_ptr<ServerSessionBase>> m_sessions;
+    bool m_cancelled{false};
+    // accept errors and the counters of ended sessions
+    Metrics m_metrics;
     bool m_binary{true};
+    bool m_preEncodedBroadcast{false};
+    SendQueueLimits m_sendQueueLimits;
+    WriteCoalescing m_writeCoalescing;
+    bool m_moveReceived{false};
+    StreamingReceive m_streamingReceive;
+    ReadLimits m_readLimits;
+    PingOptions m_ping;
+    CompressionOptions m_compression;
+    std::shared_ptr<ssl::context> m_sslContext;
 
     IServerSessionListener* m_listener{nullptr};
 };
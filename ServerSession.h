@@ -11,64 +11,27 @@
 #ifndef SCARYWS_SERVER_SESSION_H
 #define SCARYWS_SERVER_SESSION_H
 
-#include "IServerSessionListener.h"
-
-#include <memory>
+#include "BasicServerSession.h"
 
 #include <boost/beast/core.hpp>
-#include <boost/beast/websocket.hpp>
+#include <boost/asio/ip/tcp.hpp>
 
 namespace beast = boost::beast;
-namespace http = beast::http;
-namespace websocket = beast::websocket;
-namespace net = boost::asio;
 using tcp = boost::asio::ip::tcp;
 
-
-
 namespace scaryws
 {
 
+// instantiated in ServerSession.cpp
+extern template class BasicServerSession<beast::tcp_stream>;
+
 class ServerSession
-    : public std::enable_shared_from_this<ServerSession>
+    : public BasicServerSession<beast::tcp_stream>
 {
 public:
     ServerSession(tcp::socket&& socket, bool binary);
-
-    void run(std::function<void(ServerSession*)>&& cb = [](ServerSession*){});
-
-    void send(const std::string& str);
-    void send(const std::vector<char>& data);
-
-    void setListener(IServerSessionListener* listener);
-
-    void close();
-
-private:
-    void sendNext();
-    void on_run();
-    void on_accept(beast::error_code ec);
-    void do_read();
-    void on_read(beast::error_code ec, std::size_t bytes_transferred);
-    void on_write(beast::error_code ec, std::size_t bytes_transferred);
-
-    void do_close();
-
-    void fail(beast::error_code ec, char const* what);
-
-private:
-    websocket::stream<beast::tcp_stream> m_socket;
-    beast::flat_buffer m_buffer;
-
-    std::vector<std::shared_ptr<std::vector<char>>> m_queue;
-    std::mutex m_mutex;
-
-    IServerSessionListener* m_listener{nullptr};
-
-    std::function<void(ServerSession*)> m_closedCb;
 };
 
 } // namespace scaryws
 
-
 #endif // SCARYWS_SERVER_SESSION_H
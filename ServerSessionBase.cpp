@@ -0,0 +1,513 @@
+/* A websocket server using Boost.Beast
+ *
+ * (C) Copyright Ingo Randolf 2025.
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See
+ * accompanying file LICENSE or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ *
+ */
+
+#include "ServerSessionBase.h"
+
+#include <algorithm>
+#include <iostream>
+
+namespace scaryws
+{
+
+// client ids are unique for all listeners
+static std::atomic<ClientId> nextClientId{1};
+
+ServerSessionBase::ServerSessionBase()
+    : m_id(nextClientId.fetch_add(1, std::memory_order_relaxed))
+{
+}
+
+ClientId ServerSessionBase::id() const
+{
+    return m_id;
+}
+
+bool ServerSessionBase::isOpen() const
+{
+    return m_open;
+}
+
+SendResult ServerSessionBase::send(const std::string& str, CompressionMode mode)
+{
+    return send(SharedBuffer(str), mode);
+}
+
+SendResult ServerSessionBase::send(const std::vector<char>& data, CompressionMode mode)
+{
+    return send(SharedBuffer(data), mode);
+}
+
+SendResult ServerSessionBase::send(std::string&& str, CompressionMode mode)
+{
+    return send(SharedBuffer(std::move(str)), mode);
+}
+
+SendResult ServerSessionBase::send(std::vector<char>&& data, CompressionMode mode)
+{
+    return send(SharedBuffer(std::move(data)), mode);
+}
+
+void ServerSessionBase::setListener(IServerSessionListener* listener)
+{
+    m_listener = listener;
+}
+
+void ServerSessionBase::sendQueueLimits(const SendQueueLimits& limits)
+{
+    m_queue.limits(limits);
+}
+
+void ServerSessionBase::writeCoalescing(const WriteCoalescing& coalescing)
+{
+    m_coalescing = coalescing;
+}
+
+void ServerSessionBase::moveReceived(bool move)
+{
+    m_moveReceived = move;
+}
+
+void ServerSessionBase::streamingReceive(const StreamingReceive& options)
+{
+    m_streamingReceive = options;
+}
+
+void ServerSessionBase::readLimits(const ReadLimits& limits)
+{
+    m_readLimits = limits;
+    m_buffer.limits(limits);
+}
+
+void ServerSessionBase::ping(const PingOptions& options)
+{
+    m_ping = options;
+}
+
+RoundTripTime ServerSessionBase::roundTripTime() const
+{
+    return m_rtt.get();
+}
+
+void ServerSessionBase::compression(const CompressionOptions& options)
+{
+    m_compression = options;
+}
+
+int ServerSessionBase::sharedDeflateBits() const
+{
+    return m_sharedDeflateBits.load(std::memory_order_acquire);
+}
+
+MetricsSnapshot ServerSessionBase::metrics() const
+{
+    MetricsSnapshot snapshot = m_metrics.snapshot();
+
+    snapshot.queuedMessages = m_queue.size();
+    snapshot.queuedBytes = m_queue.bytes();
+    snapshot.peakQueuedMessages = m_queue.peakSize();
+    snapshot.peakQueuedBytes = m_queue.peakBytes();
+
+    return snapshot;
+}
+
+SendResult ServerSessionBase::send(const SharedBuffer& buffer, CompressionMode mode)
+{
+    return sendFrame(FrameHeader(), buffer, mode);
+}
+
+SendResult ServerSessionBase::sendFrame(const FrameHeader& header, const SharedBuffer& payload, CompressionMode mode)
+{
+    OutgoingMessage message;
+    message.payload = payload;
+    message.header = header;
+    message.compression = mode;
+
+    bool start = false;
+    const SendResult result = m_queue.push(std::move(message), start);
+
+    if (result == SendResult::Disconnected)
+    {
+        close();
+    }
+    else if (start)
+    {
+        startSending();
+    }
+
+    return result;
+}
+
+SendResult ServerSessionBase::sendStream(ChunkProducer producer, CompressionMode mode)
+{
+    OutgoingMessage message;
+    message.compression = mode;
+    message.producer = std::make_shared<ChunkProducer>(std::move(producer));
+
+    bool start = false;
+    const SendResult result = m_queue.push(std::move(message), start);
+
+    if (result == SendResult::Disconnected)
+    {
+        close();
+    }
+    else if (start)
+    {
+        startSending();
+    }
+
+    return result;
+}
+
+void ServerSessionBase::on_write(beast::error_code ec,
+                                 std::size_t bytes_transferred)
+{
+    boost::ignore_unused(bytes_transferred);
+
+    if (ec == websocket::error::closed ||
+        ec == boost::asio::error::operation_aborted)
+    {
+        return closed(ec);
+    }
+
+    if (ec)
+    {
+        // the stream is broken, nothing more is written
+        return fail(ec, "write");
+    }
+
+    const auto now = std::chrono::steady_clock::now();
+    const auto writeTime = std::chrono::duration_cast<std::chrono::microseconds>(now - m_writeStarted);
+    size_t bytes = 0;
+
+    for (auto& message : m_batch)
+    {
+        bytes += message.payload.size();
+        m_metrics.written(std::chrono::duration_cast<std::chrono::microseconds>(m_writeStarted - message.queued),
+                           writeTime);
+    }
+
+    m_metrics.sent(m_batch.size(), bytes);
+
+    if (m_queue.pop())
+    {
+        sendNext();
+    }
+}
+
+void ServerSessionBase::on_write_chunk(beast::error_code ec,
+                                       std::size_t bytes_transferred)
+{
+    // release the written chunk before producing the next one
+    m_chunk = SharedBuffer();
+
+    if (!ec)
+    {
+        m_metrics.sent(0, bytes_transferred);
+    }
+
+    if (ec ||
+        m_chunkLast)
+    {
+        m_streaming = false;
+        return on_write(ec, bytes_transferred);
+    }
+
+    writeChunk();
+}
+
+bool ServerSessionBase::nextChunk()
+{
+    const OutgoingMessage& message = m_batch.front();
+
+    m_chunk = SharedBuffer();
+    m_chunkLast = false;
+
+    if (!(*message.producer)(m_chunk, m_chunkLast))
+    {
+        return false;
+    }
+
+    if (!m_streaming)
+    {
+        // the first chunk decides if the message is compressed
+        m_streaming = true;
+        m_chunkCompress = shouldCompress(message.compression, m_chunk.size(), m_compression);
+    }
+
+    return true;
+}
+
+size_t ServerSessionBase::nextMessages()
+{
+    // the messages stay in the queue until the write completed
+    size_t count = 0;
+
+    if (m_coalescing.enabled &&
+        !m_deflate.enabled)
+    {
+        count = m_queue.front(m_batch, m_coalescing.maxBytes);
+    }
+    else
+    {
+        m_batch.resize(1);
+        count = m_queue.front(m_batch.front()) ? 1 : 0;
+    }
+
+    m_writeStarted = std::chrono::steady_clock::now();
+
+    return count;
+}
+
+bool ServerSessionBase::streamWrite() const
+{
+    const FrameHeader& header = m_batch.front().header;
+
+    return m_batch.size() == 1 &&
+            (header.empty() ||
+             (m_deflate.enabled && !m_deflate.serverNoContextTakeover && !header.compressed()));
+}
+
+bool ServerSessionBase::compressNext() const
+{
+    const OutgoingMessage& message = m_batch.front();
+    return shouldCompress(message.compression, message.size(), m_compression);
+}
+
+void ServerSessionBase::prepareFrames(bool binary)
+{
+    m_headers.clear();
+    m_buffers.clear();
+
+    for (auto& message : m_batch)
+    {
+        m_headers.push_back(message.header.empty() ? FrameHeader(binary, message.payload.size())
+                                                   : message.header);
+    }
+
+    for (size_t i = 0; i < m_batch.size(); i++)
+    {
+        m_buffers.push_back(m_headers[i].buffer());
+        m_buffers.push_back(m_batch[i].payload.buffer());
+    }
+}
+
+void ServerSessionBase::requestReceived()
+{
+    m_buffer.consume(m_buffer.size());
+
+    m_deflate = negotiateCompression(m_request, m_compression);
+
+    // without context takeover every message is compressed on its own,
+    // a message compressed once can be sent to all of these sessions
+    if (m_deflate.enabled &&
+        m_deflate.serverNoContextTakeover)
+    {
+        m_sharedDeflateBits.store(m_deflate.serverMaxWindowBits, std::memory_order_release);
+    }
+}
+
+void ServerSessionBase::accepted()
+{
+    m_open = true;
+    m_metrics.handshakeSucceeded();
+
+    if (m_listener)
+    {
+        m_listener->clientConnected(m_id);
+    }
+}
+
+void ServerSessionBase::receivedData(bool binary)
+{
+    if (m_listener)
+    {
+        if (m_moveReceived)
+        {
+            m_listener->receivedOwned(m_buffer.release(), binary, m_id);
+        }
+        else
+        {
+            m_listener->receivedView(m_buffer.begin(), m_buffer.size(), binary, m_id);
+        }
+    }
+
+    // Clear the buffer
+    m_buffer.finish();
+}
+
+void ServerSessionBase::receivedChunk(bool binary, bool done)
+{
+    ChunkMarker marker = ChunkMarker::Continue;
+
+    if (!m_receiving)
+    {
+        marker = done ? ChunkMarker::Complete : ChunkMarker::Begin;
+    }
+    else if (done)
+    {
+        marker = ChunkMarker::Final;
+    }
+
+    m_receiving = !done;
+
+    // reads without payload, e.g. an empty frame, are not passed on
+    if (m_listener &&
+        (m_buffer.size() > 0 || marker != ChunkMarker::Continue))
+    {
+        const bool handled = m_listener->receivedChunk(m_buffer.begin(), m_buffer.size(), binary, marker, m_id);
+
+        // the listener takes whole messages, stop streaming
+        // the rest of this message is read into m_buffer
+        if (!handled &&
+            (marker == ChunkMarker::Begin || marker == ChunkMarker::Complete))
+        {
+            m_streamingReceive.enabled = false;
+            m_receiving = false;
+
+            if (done)
+            {
+                return receivedData(binary);
+            }
+
+            m_collected = m_buffer.size();
+            return;
+        }
+    }
+
+    if (done)
+    {
+        m_buffer.finish();
+    }
+    else
+    {
+        m_buffer.consume(m_buffer.size());
+    }
+}
+
+size_t ServerSessionBase::nextReadSize()
+{
+    // wait for the next message without a buffer, read its first byte
+    m_waitingForMessage = m_readLimits.releaseIdle &&
+                          !m_receiving &&
+                          m_buffer.size() == 0;
+
+    if (m_waitingForMessage)
+    {
+        return 1;
+    }
+
+    if (m_streamingReceive.enabled)
+    {
+        return std::max<size_t>(m_streamingReceive.chunkSize, m_buffer.size() + 1) - m_buffer.size();
+    }
+
+    return 0;
+}
+
+void ServerSessionBase::readCompleted(bool binary, bool done)
+{
+    if (m_waitingForMessage &&
+        !done)
+    {
+        // the first byte is passed on with the rest of its chunk or message
+        return;
+    }
+
+    // the first chunk of a message collected after streaming stopped
+    // is already counted
+    m_metrics.received(m_buffer.size() - m_collected, done);
+    m_collected = 0;
+
+    if (m_streamingReceive.enabled)
+    {
+        return receivedChunk(binary, done);
+    }
+
+    receivedData(binary);
+}
+
+void ServerSessionBase::closed(beast::error_code ec)
+{
+    ended(ec);
+
+    do_close();
+
+    // a failed write and the read can both end the session
+    if (m_closedCb)
+    {
+        std::function<void(ServerSessionBase*)> cb;
+        cb.swap(m_closedCb);
+        cb(this);
+    }
+}
+
+void ServerSessionBase::ended(beast::error_code ec)
+{
+    if (m_ended)
+    {
+        return;
+    }
+
+    m_ended = true;
+
+    if (m_open)
+    {
+        m_metrics.disconnected(disconnectReason(ec));
+    }
+    else
+    {
+        m_metrics.handshakeFailed(handshakeFailure(ec));
+    }
+}
+
+websocket::ping_data ServerSessionBase::nextPing()
+{
+    std::chrono::microseconds pending(0);
+    websocket::ping_data payload = m_rtt.ping(pending);
+
+    // the last ping is still not answered
+    if (pending.count() > 0)
+    {
+        checkRoundTrip(pending);
+    }
+
+    return payload;
+}
+
+void ServerSessionBase::controlFrame(websocket::frame_type kind, beast::string_view payload)
+{
+    std::chrono::microseconds rtt(0);
+
+    if (kind == websocket::frame_type::pong &&
+        m_rtt.pong(payload, rtt))
+    {
+        checkRoundTrip(rtt);
+    }
+}
+
+void ServerSessionBase::checkRoundTrip(std::chrono::microseconds rtt)
+{
+    if (m_ping.threshold.count() > 0 &&
+        rtt > m_ping.threshold &&
+        m_listener)
+    {
+        m_listener->rttExceeded(rtt, m_id);
+    }
+}
+
+void ServerSessionBase::fail(beast::error_code ec, char const* what)
+{
+    std::cerr << "ServerSession: " << what << ": " << ec.message() << "\n";
+
+    // e.g. message_too_big, the client is disconnected
+    closed(ec);
+}
+
+} // namespace scaryws
@@ -0,0 +1,202 @@
+/* A websocket server using Boost.Beast
+ *
+ * (C) Copyright Ingo Randolf 2025.
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See
+ * accompanying file LICENSE or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ *
+ */
+
+#ifndef SCARYWS_SERVER_SESSION_BASE_H
+#define SCARYWS_SERVER_SESSION_BASE_H
+
+#include "ChunkSource.h"
+#include "Compression.h"
+#include "Frame.h"
+#include "IServerSessionListener.h"
+#include "Metrics.h"
+#include "Ping.h"
+#include "ReadBuffer.h"
+#include "SendQueue.h"
+#include "SharedBuffer.h"
+#include "StreamingReceive.h"
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include <boost/beast/core.hpp>
+#include <boost/beast/websocket.hpp>
+#include <boost/asio/steady_timer.hpp>
+
+namespace beast = boost::beast;
+namespace http = beast::http;
+namespace websocket = beast::websocket;
+namespace net = boost::asio;
+using tcp = boost::asio::ip::tcp;
+
+namespace scaryws
+{
+
+// the part of a server session which does not depend on the transport
+class ServerSessionBase
+{
+public:
+    ServerSessionBase();
+    virtual ~ServerSessionBase() = default;
+
+    ClientId id() const;
+    // the websocket handshake completed, on the session strand
+    bool isOpen() const;
+
+    SendResult send(const std::string& str, CompressionMode mode = CompressionMode::Auto);
+    SendResult send(const std::vector<char>& data, CompressionMode mode = CompressionMode::Auto);
+    SendResult send(std::string&& str, CompressionMode mode = CompressionMode::Auto);
+    SendResult send(std::vector<char>&& data, CompressionMode mode = CompressionMode::Auto);
+    SendResult send(const SharedBuffer& buffer, CompressionMode mode = CompressionMode::Auto);
+
+    // send a pre-encoded frame
+    // header and payload are written to the socket as they are,
+    // mode is used if the session compresses the message itself
+    SendResult sendFrame(const FrameHeader& header, const SharedBuffer& payload, CompressionMode mode = CompressionMode::Auto);
+
+    // send a message in fragments produced by producer
+    SendResult sendStream(ChunkProducer producer, CompressionMode mode = CompressionMode::Auto);
+
+    void setListener(IServerSessionListener* listener);
+    void sendQueueLimits(const SendQueueLimits& limits);
+    void writeCoalescing(const WriteCoalescing& coalescing);
+    // pass received messages to receivedOwned
+    void moveReceived(bool move);
+    // pass received messages in chunks to receivedChunk
+    void streamingReceive(const StreamingReceive& options);
+    void readLimits(const ReadLimits& limits);
+    void ping(const PingOptions& options);
+
+    // from any thread
+    RoundTripTime roundTripTime() const;
+    void compression(const CompressionOptions& options);
+
+    // server window bits of compressed frames this session can write as they are
+    // 0 if compression is off or the server keeps its compression context
+    int sharedDeflateBits() const;
+
+    // counters of this session, from any thread
+    MetricsSnapshot metrics() const;
+
+public:
+    virtual void run(std::function<void(ServerSessionBase*)>&& cb) = 0;
+    virtual void close() = 0;
+
+protected:
+    // called from any thread when the queue needs its consumer
+    virtual void startSending() = 0;
+
+    // called on the session strand
+    virtual void sendNext() = 0;
+    virtual void do_close() = 0;
+
+    void on_write(beast::error_code ec, std::size_t bytes_transferred);
+
+    // write m_chunk as the next fragment of the streamed message in m_batch
+    virtual void writeChunk() = 0;
+    void on_write_chunk(beast::error_code ec, std::size_t bytes_transferred);
+
+    // get the next chunk of the streamed message into m_chunk
+    // returns false if the producer aborted the message
+    bool nextChunk();
+
+    // take the messages for the next write from the queue
+    // returns the number of messages in m_batch
+    size_t nextMessages();
+
+    // m_batch is written by the websocket stream
+    // single messages without a frame header, and broadcast frames this
+    // session has to compress with its own context
+    bool streamWrite() const;
+    bool compressNext() const;
+
+    // put the frames of m_batch into m_buffers
+    // server frames are not masked, the payloads are written as they are
+    void prepareFrames(bool binary);
+
+    // the handshake request is in m_request
+    void requestReceived();
+    void accepted();
+    void receivedData(bool binary);
+    // streaming receive: pass the chunk in m_buffer
+    // done if it ends the message
+    void receivedChunk(bool binary, bool done);
+
+    // bytes for the next read of the stream
+    // 0 reads the rest of the message
+    size_t nextReadSize();
+    // a read completed, done if it ends the message
+    void readCompleted(bool binary, bool done);
+
+    // the payload of the next ping
+    websocket::ping_data nextPing();
+    // set as control callback of the websocket stream
+    void controlFrame(websocket::frame_type kind, beast::string_view payload);
+    void checkRoundTrip(std::chrono::microseconds rtt);
+    // the connection ended, removes the session from its listener once
+    void closed(beast::error_code ec);
+    // count the end of the session once
+    void ended(beast::error_code ec);
+
+    // report the error and close the session
+    void fail(beast::error_code ec, char const* what);
+
+protected:
+    ReadBuffer m_buffer;
+    bool m_moveReceived{false};
+    StreamingReceive m_streamingReceive;
+    // a message is being received in chunks
+    bool m_receiving{false};
+    // bytes in m_buffer already counted, when streaming stopped
+    // because the listener does not take chunks
+    size_t m_collected{0};
+    ReadLimits m_readLimits;
+    // reading the first byte of the next message
+    bool m_waitingForMessage{false};
+
+    PingOptions m_ping;
+    RttMeter m_rtt;
+
+    http::request<http::string_body> m_request;
+    CompressionOptions m_compression;
+    NegotiatedCompression m_deflate;
+    std::atomic<int> m_sharedDeflateBits{0};
+
+    SendQueue m_queue;
+    WriteCoalescing m_coalescing;
+
+    // only accessed on the session strand
+    bool m_open{false};
+    std::vector<OutgoingMessage> m_batch;
+    // when the write of m_batch started
+    std::chrono::steady_clock::time_point m_writeStarted;
+    std::vector<FrameHeader> m_headers;
+    std::vector<net::const_buffer> m_buffers;
+
+    // the streamed message being written
+    SharedBuffer m_chunk;
+    bool m_chunkLast{false};
+    bool m_chunkCompress{false};
+    bool m_streaming{false};
+
+    Metrics m_metrics;
+    bool m_ended{false};
+
+    const ClientId m_id;
+    IServerSessionListener* m_listener{nullptr};
+
+    std::function<void(ServerSessionBase*)> m_closedCb;
+};
+
+} // namespace scaryws
+
+#endif // SCARYWS_SERVER_SESSION_BASE_H
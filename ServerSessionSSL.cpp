@@ -0,0 +1,45 @@
+/* A websocket server using Boost.Beast
+ *
+ * (C) Copyright Ingo Randolf 2025.
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See
+ * accompanying file LICENSE or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ *
+ */
+
+#include "ServerSessionSSL.h"
+
+namespace scaryws
+{
+
+template class BasicServerSession<ssl::stream<beast::tcp_stream>>;
+
+ServerSessionSSL::ServerSessionSSL(tcp::socket&& socket, ssl::context& ctx, bool binary)
+    : BasicServerSession(binary, std::move(socket), ctx)
+{
+}
+
+void ServerSessionSSL::handshake()
+{
+    // Set the timeout for the ssl handshake
+    beast::get_lowest_layer(m_socket).expires_after(std::chrono::seconds(30));
+
+    // Perform the SSL handshake
+    m_socket.next_layer().next_layer().async_handshake(
+        ssl::stream_base::server,
+        beast::bind_front_handler(&ServerSessionSSL::on_ssl_handshake,
+                                  std::static_pointer_cast<ServerSessionSSL>(shared_from_this())));
+}
+
+void ServerSessionSSL::on_ssl_handshake(beast::error_code ec)
+{
+    if (ec)
+    {
+        return fail(ec, "ssl_handshake");
+    }
+
+    readRequest();
+}
+
+} // namespace scaryws
@@ -0,0 +1,56 @@
+/* A websocket server using Boost.Beast
+ *
+ * (C) Copyright Ingo Randolf 2025.
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See
+ * accompanying file LICENSE or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ *
+ */
+
+#ifndef SCARYWS_SERVER_SESSION_SSL_H
+#define SCARYWS_SERVER_SESSION_SSL_H
+
+#include "BasicServerSession.h"
+
+#include <string>
+
+#include <boost/beast/core.hpp>
+#include <boost/beast/websocket/ssl.hpp>
+#include <boost/asio/ssl.hpp>
+
+namespace beast = boost::beast;
+namespace ssl = boost::asio::ssl;
+using tcp = boost::asio::ip::tcp;
+
+namespace scaryws
+{
+
+// certificate and key for wss:// - files in PEM format
+struct TlsOptions
+{
+    bool enabled{false};
+    std::string certificateChainFile;
+    std::string privateKeyFile;
+    // used if the private key is encrypted
+    std::string privateKeyPassword;
+};
+
+// instantiated in ServerSessionSSL.cpp
+extern template class BasicServerSession<ssl::stream<beast::tcp_stream>>;
+
+class ServerSessionSSL
+    : public BasicServerSession<ssl::stream<beast::tcp_stream>>
+{
+public:
+    ServerSessionSSL(tcp::socket&& socket, ssl::context& ctx, bool binary);
+
+private:
+    // the TLS handshake
+    void handshake() override;
+    void on_ssl_handshake(beast::error_code ec);
+};
+
+} // namespace scaryws
+
+#endif // SCARYWS_SERVER_SESSION_SSL_H
@@ -0,0 +1,27 @@
+/* A websocket server using Boost.Beast
+ *
+ * (C) Copyright Ingo Randolf 2025.
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See
+ * accompanying file LICENSE or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ *
+ */
+
+#include "ServerSessionUnix.h"
+
+#ifdef BOOST_ASIO_HAS_LOCAL_SOCKETS
+
+namespace scaryws
+{
+
+template class BasicServerSession<beast::basic_stream<stream_protocol>>;
+
+ServerSessionUnix::ServerSessionUnix(stream_protocol::socket&& socket, bool binary)
+    : BasicServerSession(binary, std::move(socket))
+{
+}
+
+} // namespace scaryws
+
+#endif // BOOST_ASIO_HAS_LOCAL_SOCKETS
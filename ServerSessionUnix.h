@@ -0,0 +1,44 @@
+/* A websocket server using Boost.Beast
+ *
+ * (C) Copyright Ingo Randolf 2025.
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See
+ * accompanying file LICENSE or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ *
+ */
+
+#ifndef SCARYWS_SERVER_SESSION_UNIX_H
+#define SCARYWS_SERVER_SESSION_UNIX_H
+
+#include "BasicServerSession.h"
+
+#include <boost/beast/core.hpp>
+#include <boost/asio/local/stream_protocol.hpp>
+
+// not every platform has unix domain sockets
+#ifdef BOOST_ASIO_HAS_LOCAL_SOCKETS
+
+namespace beast = boost::beast;
+namespace net = boost::asio;
+using stream_protocol = net::local::stream_protocol;
+
+namespace scaryws
+{
+
+// instantiated in ServerSessionUnix.cpp
+extern template class BasicServerSession<beast::basic_stream<stream_protocol>>;
+
+// a session accepted on a unix domain socket
+class ServerSessionUnix
+    : public BasicServerSession<beast::basic_stream<stream_protocol>>
+{
+public:
+    ServerSessionUnix(stream_protocol::socket&& socket, bool binary);
+};
+
+} // namespace scaryws
+
+#endif // BOOST_ASIO_HAS_LOCAL_SOCKETS
+
+#endif // SCARYWS_SERVER_SESSION_UNIX_H
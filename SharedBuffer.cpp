@@ -0,0 +1,83 @@
+/* A websocket server and client using Boost.Beast
+ *
+ * (C) Copyright Ingo Randolf 2025.
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See
+ * accompanying file LICENSE or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ *
+ */
+
+#include "SharedBuffer.h"
+
+namespace scaryws
+{
+
+SharedBuffer::SharedBuffer()
+{}
+
+SharedBuffer::SharedBuffer(const std::string& str)
+{
+    auto data = std::make_shared<const std::vector<char>>(str.begin(), str.end());
+    m_data = data->data();
+    m_size = data->size();
+    m_owner = std::move(data);
+}
+
+SharedBuffer::SharedBuffer(const std::vector<char>& data)
+{
+    auto copy = std::make_shared<const std::vector<char>>(data);
+    m_data = copy->data();
+    m_size = copy->size();
+    m_owner = std::move(copy);
+}
+
+SharedBuffer::SharedBuffer(std::string&& str)
+{
+    auto data = std::make_shared<const std::string>(std::move(str));
+    m_data = data->data();
+    m_size = data->size();
+    m_owner = std::move(data);
+}
+
+SharedBuffer::SharedBuffer(std::vector<char>&& data)
+{
+    auto owned = std::make_shared<const std::vector<char>>(std::move(data));
+    m_data = owned->data();
+    m_size = owned->size();
+    m_owner = std::move(owned);
+}
+
+SharedBuffer::SharedBuffer(const char* data, size_t size, std::function<void()> release)
+    : m_owner(data, [release](const void*)
+    {
+        if (release)
+        {
+            release();
+        }
+    })
+    , m_data(data)
+    , m_size(size)
+{}
+
+const char* SharedBuffer::data() const
+{
+    return m_data;
+}
+
+size_t SharedBuffer::size() const
+{
+    return m_size;
+}
+
+bool SharedBuffer::empty() const
+{
+    return m_size == 0;
+}
+
+net::const_buffer SharedBuffer::buffer() const
+{
+    return net::const_buffer(m_data, m_size);
+}
+
+} // namespace scaryws
@@ -0,0 +1,62 @@
+/* A websocket server and client using Boost.Beast
+ *
+ * (C) Copyright Ingo Randolf 2025.
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See
+ * accompanying file LICENSE or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ *
+ */
+
+#ifndef SCARYWS_SHARED_BUFFER_H
+#define SCARYWS_SHARED_BUFFER_H
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <boost/asio/buffer.hpp>
+
+namespace net = boost::asio;
+
+namespace scaryws
+{
+
+// immutable, reference-counted payload
+// copies of a SharedBuffer share the same data. this allows to queue
+// one payload on many sessions without copying it per session.
+class SharedBuffer
+{
+public:
+    SharedBuffer();
+
+    // copy the data
+    explicit SharedBuffer(const std::string& str);
+    explicit SharedBuffer(const std::vector<char>& data);
+
+    // take over the storage without copying
+    explicit SharedBuffer(std::string&& str);
+    explicit SharedBuffer(std::vector<char>&& data);
+
+    // borrow caller-owned data
+    // the data must stay valid and unchanged until release is called.
+    // release is called once when the last copy is gone,
+    // possibly on an io thread.
+    SharedBuffer(const char* data, size_t size, std::function<void()> release);
+
+    const char* data() const;
+    size_t size() const;
+    bool empty() const;
+
+    net::const_buffer buffer() const;
+
+private:
+    std::shared_ptr<const void> m_owner;
+    const char* m_data{nullptr};
+    size_t m_size{0};
+};
+
+} // namespace scaryws
+
+#endif // SCARYWS_SHARED_BUFFER_H
@@ -0,0 +1,44 @@
+/* A websocket server and client using Boost.Beast
+ *
+ * (C) Copyright Ingo Randolf 2025.
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See
+ * accompanying file LICENSE or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ *
+ */
+
+#ifndef SCARYWS_STREAMING_RECEIVE_H
+#define SCARYWS_STREAMING_RECEIVE_H
+
+#include <cstddef>
+
+namespace scaryws
+{
+
+// pass received messages in chunks to receivedChunk
+// a message is never held as a whole, the read buffer stays
+// at chunkSize. chunks do not follow the frame boundaries.
+// a listener not overriding receivedChunk gets whole messages,
+// bounded by ReadLimits like without streaming receive.
+struct StreamingReceive
+{
+    bool enabled{false};
+    size_t chunkSize{64 * 1024};
+};
+
+// position of a received chunk in its message
+enum class ChunkMarker
+{
+    // the first chunk, more follow
+    Begin,
+    Continue,
+    // the last chunk
+    Final,
+    // the whole message in one chunk
+    Complete
+};
+
+} // namespace scaryws
+
+#endif // SCARYWS_STREAMING_RECEIVE_H
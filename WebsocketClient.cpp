@@ -15,10 +15,6 @@
 #include <thread>
 #include <iostream>
 
-
-#include <boost/certify/extensions.hpp>
-#include <boost/certify/https_verification.hpp>
-
 namespace scaryws
 {
 
@@ -36,9 +32,23 @@ WebsocketClient::~WebsocketClient()
         delete m_thread;
         m_thread = nullptr;
     }
+
+    waitForSession();
 }
 
 void WebsocketClient::connect(const std::string& url)
+{
+    m_endpoints.clear();
+    start(url);
+}
+
+void WebsocketClient::connect(const std::string& url, const std::vector<tcp::endpoint>& endpoints)
+{
+    m_endpoints = endpoints;
+    start(url);
+}
+
+void WebsocketClient::start(const std::string& url)
 {
     auto url_view = boost::urls::parse_uri(url);
     if (!url_view.has_error())
@@ -52,6 +62,14 @@ void WebsocketClient::connect(const std::string& url)
         return;
     }
 
+#ifndef BOOST_ASIO_HAS_LOCAL_SOCKETS
+    if (m_url.scheme().find("ws+unix", 0) == 0)
+    {
+        std::cerr << "ws-client: ws+unix is not supported on this platform\n";
+        return;
+    }
+#endif
+
     if (m_thread)
     {
         disconnect();
@@ -60,14 +78,25 @@ void WebsocketClient::connect(const std::string& url)
         m_thread = nullptr;
     }
 
+    if (!waitForSession())
+    {
+        return;
+    }
+
     // cout << "host: " << m_url.host() << endl;
     // cout << "port: " << m_url.port() << endl;
     // cout << "path: " << m_url.path() << endl;
     // cout << "query: " << m_url.query() << endl;
 
-    if (m_url.scheme().find("wss", 0) == 0)
+    if (m_eventLoop)
     {
-        m_thread = new std::thread(&WebsocketClient::runSSL, this, m_url);
+        // no thread, the session runs on the loop
+        std::lock_guard<std::recursive_mutex> lock(m_mutex);
+
+        m_sessionLoop = m_eventLoop;
+        m_sessionRunning = true;
+
+        startSession(m_sessionLoop->next(), m_url);
     }
     else
     {
@@ -75,11 +104,36 @@ void WebsocketClient::connect(const std::string& url)
     }
 }
 
+MetricsSnapshot WebsocketClient::metrics() const
+{
+    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+
+    if (m_session)
+    {
+        return m_session->metrics();
+    }
+
+    return m_metrics->snapshot();
+}
+
+RoundTripTime WebsocketClient::roundTripTime() const
+{
+    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+
+    if (m_session)
+    {
+        return m_session->roundTripTime();
+    }
+
+    return RoundTripTime();
+}
+
 void WebsocketClient::reconnect()
 {
     if (!m_url.empty())
     {
-        connect(m_url.c_str());
+        // keeps pre-resolved endpoints
+        start(m_url.c_str());
     }
     else
     {
@@ -98,16 +152,14 @@ void WebsocketClient::disconnect()
 
     bool is_connected = isConnected();
 
-    if (is_connected)
+    if (is_connected ||
+        !m_ioc)
     {
+        // a session on an event loop is closed while connecting, too
         if (m_session)
         {
             m_session->close();
         }
-        else if (m_sslSession)
-        {
-            m_sslSession->close();
-        }
         else
         {
             // std::cout << "close: no session" << std::endl;
@@ -119,44 +171,52 @@ void WebsocketClient::disconnect()
     }
 
     m_session.reset();
-    m_sslSession.reset();
 }
 
 
-void WebsocketClient::send(const std::string& str)
+SendResult WebsocketClient::send(const std::string& str, CompressionMode mode)
+{
+    return send(SharedBuffer(str), mode);
+}
+
+SendResult WebsocketClient::send(const std::vector<char>& data, CompressionMode mode)
+{
+    return send(SharedBuffer(data), mode);
+}
+
+SendResult WebsocketClient::send(std::string&& str, CompressionMode mode)
+{
+    return send(SharedBuffer(std::move(str)), mode);
+}
+
+SendResult WebsocketClient::send(std::vector<char>&& data, CompressionMode mode)
+{
+    return send(SharedBuffer(std::move(data)), mode);
+}
+
+SendResult WebsocketClient::send(const SharedBuffer& buffer, CompressionMode mode)
 {
     std::lock_guard<std::recursive_mutex> lock(m_mutex);
 
     if (m_session)
     {
-        m_session->send(str);
-    }
-    else if (m_sslSession)
-    {
-        m_sslSession->send(str);
-    }
-    else
-    {
-        // std::cout << "send: no session" << std::endl;
+        return m_session->send(buffer, mode);
     }
+
+    // std::cout << "send: no session" << std::endl;
+    return SendResult::NotConnected;
 }
 
-void WebsocketClient::send(const std::vector<char>& data)
+SendResult WebsocketClient::sendStream(ChunkProducer producer, CompressionMode mode)
 {
     std::lock_guard<std::recursive_mutex> lock(m_mutex);
 
     if (m_session)
     {
-        m_session->send(data);
-    }
-    else if (m_sslSession)
-    {
-        m_sslSession->send(data);
-    }
-    else
-    {
-        // std::cout << "send: no session" << std::endl;
+        return m_session->sendStream(std::move(producer), mode);
     }
+
+    return SendResult::NotConnected;
 }
 
 bool WebsocketClient::isConnected() const
@@ -167,10 +227,6 @@ bool WebsocketClient::isConnected() const
     {
         return m_session->isConnected();
     }
-    else if (m_sslSession)
-    {
-        return m_sslSession->isConnected();
-    }
 
     return false;
 }
@@ -195,6 +251,116 @@ bool WebsocketClient::verifyPeer() const
     return m_verifyPeer;
 }
 
+void WebsocketClient::sendQueueLimits(const SendQueueLimits& limits)
+{
+    m_sendQueueLimits = limits;
+}
+
+SendQueueLimits WebsocketClient::sendQueueLimits() const
+{
+    return m_sendQueueLimits;
+}
+
+void WebsocketClient::writeCoalescing(const WriteCoalescing& coalescing)
+{
+    m_writeCoalescing = coalescing;
+}
+
+WriteCoalescing WebsocketClient::writeCoalescing() const
+{
+    return m_writeCoalescing;
+}
+
+void WebsocketClient::moveReceived(bool move)
+{
+    m_moveReceived = move;
+}
+
+bool WebsocketClient::moveReceived() const
+{
+    return m_moveReceived;
+}
+
+void WebsocketClient::streamingReceive(const StreamingReceive& options)
+{
+    m_streamingReceive = options;
+}
+
+StreamingReceive WebsocketClient::streamingReceive() const
+{
+    return m_streamingReceive;
+}
+
+void WebsocketClient::readLimits(const ReadLimits& limits)
+{
+    m_readLimits = limits;
+}
+
+ReadLimits WebsocketClient::readLimits() const
+{
+    return m_readLimits;
+}
+
+void WebsocketClient::ping(const PingOptions& options)
+{
+    m_ping = options;
+}
+
+PingOptions WebsocketClient::ping() const
+{
+    return m_ping;
+}
+
+void WebsocketClient::compression(const CompressionOptions& options)
+{
+    m_compression = options;
+}
+
+CompressionOptions WebsocketClient::compression() const
+{
+    return m_compression;
+}
+
+void WebsocketClient::autoReconnect(const ReconnectOptions& options)
+{
+    m_autoReconnect = options;
+}
+
+ReconnectOptions WebsocketClient::autoReconnect() const
+{
+    return m_autoReconnect;
+}
+
+void WebsocketClient::tlsContext(std::shared_ptr<ClientTlsContext> ctx)
+{
+    m_tlsContext = ctx;
+}
+
+std::shared_ptr<ClientTlsContext> WebsocketClient::tlsContext() const
+{
+    return m_tlsContext;
+}
+
+void WebsocketClient::resolveCache(std::shared_ptr<ResolveCache> cache)
+{
+    m_resolveCache = cache;
+}
+
+std::shared_ptr<ResolveCache> WebsocketClient::resolveCache() const
+{
+    return m_resolveCache;
+}
+
+void WebsocketClient::eventLoop(std::shared_ptr<ClientEventLoop> loop)
+{
+    m_eventLoop = loop;
+}
+
+std::shared_ptr<ClientEventLoop> WebsocketClient::eventLoop() const
+{
+    return m_eventLoop;
+}
+
 
 // threaded functions
 
@@ -205,7 +371,11 @@ void WebsocketClient::connected()
 
 void WebsocketClient::error(int code, const std::string& message)
 {
-    disconnect();
+    // the session reconnects on its own
+    if (!m_autoReconnect.enabled)
+    {
+        disconnect();
+    }
 }
 
 void WebsocketClient::disconnected(uint16_t code)
@@ -226,14 +396,11 @@ void WebsocketClient::received(const std::string& msg)
 
 void WebsocketClient::run(const boost::urls::url& url)
 {
-    // net::io_context ioc;
     m_ioc = std::make_shared<net::io_context>();
 
     {
         std::lock_guard<std::recursive_mutex> lock(m_mutex);
-        m_session = std::make_shared<ClientSession>(*m_ioc, m_binary);
-        m_session->setListener(this);
-        m_session->run(url);
+        startSession(*m_ioc, url);
     }
 
     try
@@ -248,7 +415,6 @@ void WebsocketClient::run(const boost::urls::url& url)
     // call closed
     disconnected(0);
 
-    if (m_session)
     {
         std::lock_guard<std::recursive_mutex> lock(m_mutex);
         m_session.reset();
@@ -259,54 +425,97 @@ void WebsocketClient::run(const boost::urls::url& url)
     // std::cout << "client session ended" << std::endl;
 }
 
-void WebsocketClient::runSSL(const boost::urls::url& url)
+std::shared_ptr<ClientSessionBase> WebsocketClient::createSession(net::io_context& ioc, const boost::urls::url& url)
 {
-    m_ioc = std::make_shared<net::io_context>();
-
-    ssl::context ctx{ssl::context::tls_client};
-
-    if (m_verifyPeer)
+#ifdef BOOST_ASIO_HAS_LOCAL_SOCKETS
+    if (url.scheme().find("ws+unix", 0) == 0)
     {
-        ctx.set_verify_mode(net::ssl::verify_peer |
-                            net::ssl::verify_fail_if_no_peer_cert);
+        return std::make_shared<ClientSessionUnix>(ioc, m_binary);
+    }
+#endif
 
-        ctx.set_default_verify_paths();
+    if (url.scheme().find("wss", 0) == 0)
+    {
+        // the context is set up once, not on every connect
+        std::shared_ptr<ClientTlsContext> tls = m_tlsContext ? m_tlsContext
+                                                             : ClientTlsContext::shared(m_verifyPeer);
 
-        boost::certify::enable_native_https_server_verification(ctx);
+        return std::make_shared<ClientSessionSSL>(ioc, tls, m_binary);
     }
-    else
+
+    return std::make_shared<ClientSession>(ioc, m_binary);
+}
+
+void WebsocketClient::startSession(net::io_context& ioc, const boost::urls::url& url)
+{
+    m_session = createSession(ioc, url);
+    m_session->setListener(this);
+    m_session->sendQueueLimits(m_sendQueueLimits);
+    m_session->writeCoalescing(m_writeCoalescing);
+    m_session->moveReceived(m_moveReceived);
+    m_session->streamingReceive(m_streamingReceive);
+    m_session->readLimits(m_readLimits);
+    m_session->ping(m_ping);
+    m_session->compression(m_compression);
+    m_session->reconnect(m_autoReconnect);
+    m_session->metrics(m_metrics);
+    // not used by unix domain sockets
+    m_session->resolveCache(m_resolveCache);
+    m_session->endpoints(m_endpoints);
+    m_session->closedCallback(std::bind(&WebsocketClient::sessionEnded, this));
+    m_session->run(url);
+}
+
+// called on the event loop
+// sessions run by an own thread end with their io_context
+void WebsocketClient::sessionEnded()
+{
     {
-        ctx.set_verify_mode(net::ssl::verify_none);
+        std::lock_guard<std::recursive_mutex> lock(m_mutex);
+
+        if (!m_sessionRunning)
+        {
+            return;
+        }
     }
 
+    // call closed
+    disconnected(0);
 
     {
         std::lock_guard<std::recursive_mutex> lock(m_mutex);
-        m_sslSession = std::make_shared<ClientSessionSSL>(*m_ioc, ctx, m_binary);
-        m_sslSession->setListener(this);
-        m_sslSession->run(url);
+        m_session.reset();
+        m_sessionRunning = false;
     }
 
-    try
+    m_sessionEndedCondition.notify_all();
+}
+
+bool WebsocketClient::waitForSession()
+{
+    std::unique_lock<std::recursive_mutex> lock(m_mutex);
+
+    if (!m_sessionRunning)
     {
-        m_ioc->run();
+        return true;
     }
-    catch(std::exception& ex)
+
+    if (m_sessionLoop->runningInThisThread())
     {
-        std::cerr << "execption running ws-client ssl-io:" << ex.what() << "\n";
+        // the session can not end while we wait for it
+        std::cerr << "ws-client: can not wait for the session on its event loop\n";
+        disconnect();
+        return false;
     }
 
-    // call closed
-    disconnected(0);
+    disconnect();
 
+    m_sessionEndedCondition.wait(lock, [this]
     {
-        std::lock_guard<std::recursive_mutex> lock(m_mutex);
-        m_sslSession.reset();
-    }
-
-    m_ioc.reset();
+        return !m_sessionRunning;
+    });
 
-    // std::cout << "client ssl session ended" << std::endl;
+    return true;
 }
 
 } // namespace scaryws
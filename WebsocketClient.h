@@ -11,13 +11,18 @@
 #ifndef SCARYWS_WEBSOCKET_CLIENT_H
 #define SCARYWS_WEBSOCKET_CLIENT_H
 
+#include <condition_variable>
 #include <thread>
 
 #include <boost/url.hpp>
 
+#include "ClientEventLoop.h"
 #include "ClientSession.h"
 #include "ClientSessionSSL.h"
+#include "ClientSessionUnix.h"
+#include "ClientTlsContext.h"
 #include "IClientSessionListener.h"
+#include "ResolveCache.h"
 
 namespace scaryws
 {
@@ -37,15 +42,105 @@ public:
     void verifyPeer(bool verify);
     bool verifyPeer() const;
 
+    // limits for the send queue - default: unlimited
+    // takes effect with the next call to connect
+    void sendQueueLimits(const SendQueueLimits& limits);
+    SendQueueLimits sendQueueLimits() const;
+
+    // write queued messages together - default: disabled
+    // trades latency for throughput with bursts of small messages
+    // takes effect with the next call to connect
+    void writeCoalescing(const WriteCoalescing& coalescing);
+    WriteCoalescing writeCoalescing() const;
+
+    // pass received messages to receivedOwned - default: false
+    // the message is moved out of the read buffer instead of being copied,
+    // the next message needs a new buffer
+    // takes effect with the next call to connect
+    void moveReceived(bool move);
+    bool moveReceived() const;
+
+    // pass received messages in chunks to receivedChunk - default: disabled
+    // large messages are processed while they arrive
+    // takes effect with the next call to connect
+    void streamingReceive(const StreamingReceive& options);
+    StreamingReceive streamingReceive() const;
+
+    // largest received message and memory kept by the read buffer
+    // - default: 16 MB, 64 KB
+    // takes effect with the next call to connect
+    void readLimits(const ReadLimits& limits);
+    ReadLimits readLimits() const;
+
+    // ping the server to measure the round trip time - default: disabled
+    // takes effect with the next call to connect
+    void ping(const PingOptions& options);
+    PingOptions ping() const;
+
+    // permessage-deflate - default: disabled
+    // takes effect with the next call to connect
+    void compression(const CompressionOptions& options);
+    CompressionOptions compression() const;
+
+    // reconnect lost connections with backoff - default: disabled
+    // the session reconnects on its io_context, the send queue, the read
+    // buffer and the TLS context are kept. messages sent while reconnecting
+    // are written after the connection is open again.
+    // takes effect with the next call to connect
+    void autoReconnect(const ReconnectOptions& options);
+    ReconnectOptions autoReconnect() const;
+
+    // TLS context for wss:// - default: the process-wide context for verifyPeer
+    // the context keeps TLS sessions, reconnects resume them.
+    // if set, verifyPeer of the context is used.
+    // takes effect with the next call to connect
+    void tlsContext(std::shared_ptr<ClientTlsContext> ctx);
+    std::shared_ptr<ClientTlsContext> tlsContext() const;
+
+    // cache resolved endpoints - default: none
+    // ResolveCache::shared() is shared by all clients
+    // takes effect with the next call to connect
+    void resolveCache(std::shared_ptr<ResolveCache> cache);
+    std::shared_ptr<ResolveCache> resolveCache() const;
+
+    // run the connection on a shared event loop - default: none
+    // without a loop every connect starts an own thread and io_context.
+    // with a loop, connect, reconnect and the destructor wait for the
+    // running session to end and must not be called on a loop thread.
+    // takes effect with the next call to connect
+    void eventLoop(std::shared_ptr<ClientEventLoop> loop);
+    std::shared_ptr<ClientEventLoop> eventLoop() const;
+
     std::string url() const;
 
+    // ws://, wss:// or ws+unix:///path/to/socket:/request/path
     virtual void connect(const std::string& url);
+    // connect to pre-resolved endpoints, the host of url is not resolved
+    // it is still used for the Host header and TLS server name.
+    // reconnects use the same endpoints
+    void connect(const std::string& url, const std::vector<tcp::endpoint>& endpoints);
     virtual void disconnect();
-    virtual void send(const std::string& str);
-    virtual void send(const std::vector<char>& data);
+    // returns NotConnected if there is no session
+    // mode overrides the compression threshold for this message
+    virtual SendResult send(const std::string& str, CompressionMode mode = CompressionMode::Auto);
+    virtual SendResult send(const std::vector<char>& data, CompressionMode mode = CompressionMode::Auto);
+    // take over the storage without copying
+    virtual SendResult send(std::string&& str, CompressionMode mode = CompressionMode::Auto);
+    virtual SendResult send(std::vector<char>&& data, CompressionMode mode = CompressionMode::Auto);
+    // send a shared or borrowed payload without copying it
+    virtual SendResult send(const SharedBuffer& buffer, CompressionMode mode = CompressionMode::Auto);
+    // send a large message in fragments, one chunk of producer at a time
+    // a message cut off by a lost connection is not sent again
+    virtual SendResult sendStream(ChunkProducer producer, CompressionMode mode = CompressionMode::Auto);
     virtual bool isConnected() const;
     virtual void reconnect();
 
+    // counters of all connections of this client, from any thread
+    // the send queue is the one of the current connection
+    MetricsSnapshot metrics() const;
+    // round trip time of the current connection, from any thread
+    RoundTripTime roundTripTime() const;
+
 public:
     // IClientSessionListener
     void connected() override;
@@ -56,20 +151,44 @@ public:
 
 
 private:
+    void start(const std::string& url);
     void run(const boost::urls::url& url);
-    void runSSL(const boost::urls::url& url);
+    // the session for the scheme of url
+    std::shared_ptr<ClientSessionBase> createSession(net::io_context& ioc, const boost::urls::url& url);
+    void startSession(net::io_context& ioc, const boost::urls::url& url);
+    void sessionEnded();
+    // disconnect a session running on an event loop and wait until it ended
+    // returns false if it can not be waited for
+    bool waitForSession();
 
 private:
     boost::urls::url m_url;
     bool m_binary{true};
     bool m_verifyPeer{true};
+    SendQueueLimits m_sendQueueLimits;
+    WriteCoalescing m_writeCoalescing;
+    bool m_moveReceived{false};
+    StreamingReceive m_streamingReceive;
+    ReadLimits m_readLimits;
+    PingOptions m_ping;
+    CompressionOptions m_compression;
+    ReconnectOptions m_autoReconnect;
+    std::shared_ptr<ClientTlsContext> m_tlsContext;
+    std::shared_ptr<ClientEventLoop> m_eventLoop;
+    std::shared_ptr<ResolveCache> m_resolveCache;
+    std::vector<tcp::endpoint> m_endpoints;
+    std::shared_ptr<Metrics> m_metrics{std::make_shared<Metrics>()};
 
     std::thread* m_thread{nullptr};
     mutable std::recursive_mutex m_mutex;
 
     std::shared_ptr<net::io_context> m_ioc;
-    std::shared_ptr<ClientSession> m_session;
-    std::shared_ptr<ClientSessionSSL> m_sslSession;
+
+    // the loop of the last session, it has to outlive the session
+    std::shared_ptr<ClientEventLoop> m_sessionLoop;
+    bool m_sessionRunning{false};
+    std::condition_variable_any m_sessionEndedCondition;
+    std::shared_ptr<ClientSessionBase> m_session;
 };
 
 } // namespace scaryws
@@ -10,7 +10,10 @@
 
 #include "WebsocketServer.h"
 
+#include <algorithm>
+#include <functional>
 #include <iostream>
+#include <memory>
 
 #include <boost/beast/core.hpp>
 #include <boost/asio/ip/tcp.hpp>
@@ -54,6 +57,116 @@ bool WebsocketServer::binary() const
     return m_binary;
 }
 
+void WebsocketServer::threads(size_t count)
+{
+    m_threads = count;
+}
+
+size_t WebsocketServer::threads() const
+{
+    return m_threads;
+}
+
+void WebsocketServer::sharded(bool sharded)
+{
+    m_sharded = sharded;
+}
+
+bool WebsocketServer::sharded() const
+{
+    return m_sharded;
+}
+
+void WebsocketServer::preEncodedBroadcast(bool preEncoded)
+{
+    m_preEncodedBroadcast = preEncoded;
+}
+
+bool WebsocketServer::preEncodedBroadcast() const
+{
+    return m_preEncodedBroadcast;
+}
+
+void WebsocketServer::sendQueueLimits(const SendQueueLimits& limits)
+{
+    m_sendQueueLimits = limits;
+}
+
+SendQueueLimits WebsocketServer::sendQueueLimits() const
+{
+    return m_sendQueueLimits;
+}
+
+void WebsocketServer::writeCoalescing(const WriteCoalescing& coalescing)
+{
+    m_writeCoalescing = coalescing;
+}
+
+WriteCoalescing WebsocketServer::writeCoalescing() const
+{
+    return m_writeCoalescing;
+}
+
+void WebsocketServer::moveReceived(bool move)
+{
+    m_moveReceived = move;
+}
+
+bool WebsocketServer::moveReceived() const
+{
+    return m_moveReceived;
+}
+
+void WebsocketServer::streamingReceive(const StreamingReceive& options)
+{
+    m_streamingReceive = options;
+}
+
+StreamingReceive WebsocketServer::streamingReceive() const
+{
+    return m_streamingReceive;
+}
+
+void WebsocketServer::readLimits(const ReadLimits& limits)
+{
+    m_readLimits = limits;
+}
+
+ReadLimits WebsocketServer::readLimits() const
+{
+    return m_readLimits;
+}
+
+void WebsocketServer::ping(const PingOptions& options)
+{
+    m_ping = options;
+}
+
+PingOptions WebsocketServer::ping() const
+{
+    return m_ping;
+}
+
+void WebsocketServer::compression(const CompressionOptions& options)
+{
+    m_compression = options;
+}
+
+CompressionOptions WebsocketServer::compression() const
+{
+    return m_compression;
+}
+
+void WebsocketServer::tls(const TlsOptions& options)
+{
+    m_tls = options;
+}
+
+TlsOptions WebsocketServer::tls() const
+{
+    return m_tls;
+}
+
 void WebsocketServer::listen(uint16_t port, const std::string& address)
 {
     close();
@@ -75,6 +188,7 @@ void WebsocketServer::listen(uint16_t port, const std::string& address)
     }
 
     m_port = port;
+    m_localPath.clear();
 
     if (m_port > 0)
     {
@@ -82,11 +196,28 @@ void WebsocketServer::listen(uint16_t port, const std::string& address)
     }
 }
 
+void WebsocketServer::listenLocal(const std::string& path)
+{
+    close();
+
+    m_localPath = path;
+
+    if (!m_localPath.empty())
+    {
+        m_thread = new std::thread(&WebsocketServer::run, this);
+    }
+}
+
+std::string WebsocketServer::localPath() const
+{
+    return m_localPath;
+}
+
 void WebsocketServer::close()
 {
-    if (m_listener)
+    for (auto& listener : listeners())
     {
-        m_listener->cancel();
+        listener->cancel();
     }
 
     if (m_thread)
@@ -97,53 +228,164 @@ void WebsocketServer::close()
     }
 
     m_port = 0;
+    m_localPath.clear();
 }
 
 bool WebsocketServer::isListening() const
 {
-    return m_listener && m_listener->isListening();
+    for (auto& listener : listeners())
+    {
+        if (listener->isListening())
+        {
+            return true;
+        }
+    }
+
+    return false;
 }
 
 size_t WebsocketServer::clientCount() const
 {
-    if (m_listener)
+    size_t count = 0;
+
+    for (auto& listener : listeners())
+    {
+        count += listener->sessionCount();
+    }
+
+    return count;
+}
+
+MetricsSnapshot WebsocketServer::metrics() const
+{
+    MetricsSnapshot snapshot;
+    std::vector<std::shared_ptr<ServerListener>> current;
+
+    {
+        // closed listeners move their counters to m_metrics under this lock
+        std::lock_guard<std::mutex> lock(m_mutex);
+        snapshot = m_metrics.snapshot();
+        current = m_listeners;
+    }
+
+    for (auto& listener : current)
+    {
+        snapshot += listener->metrics();
+    }
+
+    return snapshot;
+}
+
+bool WebsocketServer::metrics(ClientId client, MetricsSnapshot& snapshot) const
+{
+    for (auto& listener : listeners())
     {
-        return m_listener->sessionCount();
+        if (listener->metrics(client, snapshot))
+        {
+            return true;
+        }
     }
 
-    return 0;
+    return false;
 }
 
-void WebsocketServer::sendToAll(const std::string& str, void* except)
+bool WebsocketServer::roundTripTime(ClientId client, RoundTripTime& rtt) const
 {
-    if (m_listener)
+    for (auto& listener : listeners())
     {
-        m_listener->sendToAll(str, except);
+        if (listener->roundTripTime(client, rtt))
+        {
+            return true;
+        }
     }
+
+    return false;
+}
+
+void WebsocketServer::sendToAll(const std::string& str, ClientId except, CompressionMode mode)
+{
+    sendToAll(SharedBuffer(str), except, mode);
+}
+
+void WebsocketServer::sendToAll(const std::vector<char>& data, ClientId except, CompressionMode mode)
+{
+    sendToAll(SharedBuffer(data), except, mode);
+}
+
+void WebsocketServer::sendToAll(std::string&& str, ClientId except, CompressionMode mode)
+{
+    sendToAll(SharedBuffer(std::move(str)), except, mode);
+}
+
+void WebsocketServer::sendToAll(std::vector<char>&& data, ClientId except, CompressionMode mode)
+{
+    sendToAll(SharedBuffer(std::move(data)), except, mode);
 }
 
-void WebsocketServer::sendToAll(const std::vector<char>& data, void* except)
+void WebsocketServer::sendToAll(const SharedBuffer& buffer, ClientId except, CompressionMode mode)
 {
-    if (m_listener)
+    for (auto& listener : listeners())
     {
-        m_listener->sendToAll(data, except);
+        listener->sendToAll(buffer, except, mode);
     }
 }
 
-void WebsocketServer::sendTo(const std::string& str, void* client)
+SendResult WebsocketServer::sendTo(const std::string& str, ClientId client, CompressionMode mode)
+{
+    return sendTo(SharedBuffer(str), client, mode);
+}
+
+SendResult WebsocketServer::sendTo(const std::vector<char>& data, ClientId client, CompressionMode mode)
+{
+    return sendTo(SharedBuffer(data), client, mode);
+}
+
+SendResult WebsocketServer::sendTo(std::string&& str, ClientId client, CompressionMode mode)
+{
+    return sendTo(SharedBuffer(std::move(str)), client, mode);
+}
+
+SendResult WebsocketServer::sendTo(std::vector<char>&& data, ClientId client, CompressionMode mode)
+{
+    return sendTo(SharedBuffer(std::move(data)), client, mode);
+}
+
+SendResult WebsocketServer::sendTo(const SharedBuffer& buffer, ClientId client, CompressionMode mode)
 {
-    if (m_listener)
+    for (auto& listener : listeners())
     {
-        m_listener->sendTo(str, client);
+        const SendResult result = listener->sendTo(buffer, client, mode);
+
+        if (result != SendResult::NotConnected)
+        {
+            return result;
+        }
     }
+
+    return SendResult::NotConnected;
 }
 
-void WebsocketServer::sendTo(const std::vector<char>& data, void* client)
+SendResult WebsocketServer::sendStreamTo(ChunkProducer producer, ClientId client, CompressionMode mode)
 {
-    if (m_listener)
+    for (auto& listener : listeners())
     {
-        m_listener->sendTo(data, client);
+        const SendResult result = listener->sendStreamTo(producer, client, mode);
+
+        if (result != SendResult::NotConnected)
+        {
+            return result;
+        }
     }
+
+    return SendResult::NotConnected;
+}
+
+std::vector<std::shared_ptr<ServerListener>> WebsocketServer::listeners() const
+{
+    // return a copy, listeners call back into this server
+    // while holding their own lock
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_listeners;
 }
 
 
@@ -158,20 +400,24 @@ void WebsocketServer::closed()
 
 }
 
-void WebsocketServer::clientConnected(void* client)
+void WebsocketServer::clientConnected(ClientId client)
 {
 }
 
-void WebsocketServer::clientDisconnected(void* client)
+void WebsocketServer::clientDisconnected(ClientId client)
 {
 }
 
-void WebsocketServer::received(const char* data, size_t size, void* client)
+void WebsocketServer::error(int code, const std::string& message)
+{
+}
+
+void WebsocketServer::received(const char* data, size_t size, ClientId client)
 {
     // received binary message
 }
 
-void WebsocketServer::received(const std::string& msg, void* client)
+void WebsocketServer::received(const std::string& msg, ClientId client)
 {
     // received text message
 }
@@ -179,38 +425,141 @@ void WebsocketServer::received(const std::string& msg, void* client)
 
 void WebsocketServer::run()
 {
-    // int const threads = 1;
+    const size_t threads = std::max<size_t>(m_threads, 1);
+    const bool local = !m_localPath.empty();
+    const size_t shards = (m_sharded && !local && ServerListener::reusePortSupported()) ? threads : 1;
+
+    // all listeners share one context
+    std::shared_ptr<ssl::context> sslContext;
+
+    if (m_tls.enabled &&
+        !local)
+    {
+        sslContext = createSslContext();
+
+        // the error is reported, the server does not listen
+        if (!sslContext)
+        {
+            return;
+        }
+    }
 
-    net::io_context ioc; // threads
+    // one io_context per shard
+    // a single shard is run by all threads
+    std::vector<std::unique_ptr<net::io_context>> contexts;
 
     {
         std::lock_guard<std::mutex> lock(m_mutex);
-        m_listener = std::make_shared<ServerListener>(ioc,
-                                                tcp::endpoint{m_address, m_port},
-                                                m_binary);
-        m_listener->setListener(this);
-        m_listener->run();
+
+        for (size_t i = 0; i < shards; i++)
+        {
+            contexts.emplace_back(new net::io_context(shards > 1 ? 1 : static_cast<int>(threads)));
+
+            auto listener = local ? std::make_shared<ServerListener>(*contexts.back(),
+                                                                     m_localPath,
+                                                                     m_binary)
+                                  : std::make_shared<ServerListener>(*contexts.back(),
+                                                                     tcp::endpoint{m_address, m_port},
+                                                                     m_binary,
+                                                                     shards > 1);
+            listener->setListener(this);
+            listener->preEncodedBroadcast(m_preEncodedBroadcast);
+            listener->sendQueueLimits(m_sendQueueLimits);
+            listener->writeCoalescing(m_writeCoalescing);
+            listener->moveReceived(m_moveReceived);
+            listener->streamingReceive(m_streamingReceive);
+            listener->readLimits(m_readLimits);
+            listener->ping(m_ping);
+            listener->compression(m_compression);
+            listener->sslContext(sslContext);
+            listener->run();
+
+            m_listeners.push_back(listener);
+        }
     }
 
     //
     listening();
 
-    try
+    // this thread runs the first io_context as well
+    std::vector<std::thread> workers;
+    workers.reserve(threads - 1);
+
+    for (size_t i = 1; i < threads; i++)
     {
-        ioc.run();
+        workers.emplace_back(&WebsocketServer::runContext,
+                             this,
+                             std::ref(*contexts[i % shards]));
     }
-    catch(std::exception& ex)
+
+    runContext(*contexts.front());
+
+    for (auto& worker : workers)
     {
-        std::cout << "execption running ws-server io:" << ex.what() << "\n";
+        worker.join();
     }
 
     {
         std::lock_guard<std::mutex> lock(m_mutex);
-        m_listener.reset();
+
+        for (auto& listener : m_listeners)
+        {
+            m_metrics.add(listener->metrics());
+        }
+
+        m_listeners.clear();
     }
 
     closed();
 }
 
+std::shared_ptr<ssl::context> WebsocketServer::createSslContext()
+{
+    auto ctx = std::make_shared<ssl::context>(ssl::context::tls_server);
+
+    ctx->set_options(ssl::context::default_workarounds |
+                     ssl::context::no_sslv2 |
+                     ssl::context::no_sslv3 |
+                     ssl::context::no_tlsv1 |
+                     ssl::context::no_tlsv1_1 |
+                     ssl::context::single_dh_use);
+
+    const std::string password = m_tls.privateKeyPassword;
+    ctx->set_password_callback([password](std::size_t, ssl::context_base::password_purpose)
+    {
+        return password;
+    });
+
+    beast::error_code ec;
+
+    ctx->use_certificate_chain_file(m_tls.certificateChainFile, ec);
+    if (ec)
+    {
+        error(ec.value(), "certificate: " + ec.message());
+        return nullptr;
+    }
+
+    ctx->use_private_key_file(m_tls.privateKeyFile, ssl::context::pem, ec);
+    if (ec)
+    {
+        error(ec.value(), "private key: " + ec.message());
+        return nullptr;
+    }
+
+    return ctx;
+}
+
+void WebsocketServer::runContext(net::io_context& ioc)
+{
+    try
+    {
+        ioc.run();
+    }
+    catch(std::exception& ex)
+    {
+        std::cout << "execption running ws-server io:" << ex.what() << "\n";
+    }
+}
+
 } // namespace scaryws
 
@@ -12,11 +12,16 @@
 #define SCARYWS_WEBSOCKET_SERVER_H
 
 #include <thread>
+#include <vector>
 
 #include <boost/beast/core.hpp>
 #include <boost/asio/ip/tcp.hpp>
 
+#include "Compression.h"
 #include "IServerSessionListener.h"
+#include "SendQueue.h"
+#include "ServerSessionSSL.h"
+#include "SharedBuffer.h"
 
 namespace beast = boost::beast;
 namespace net = boost::asio;
@@ -41,39 +46,158 @@ public:
     void binary(bool binary);
     bool binary() const;
 
+    // number of threads running the io_context - default: 1
+    // with more than one thread, callbacks can be called concurrently
+    // takes effect with the next call to listen
+    void threads(size_t count);
+    size_t threads() const;
+
+    // shard-per-thread mode - default: false
+    // every thread runs its own io_context and listener, all bound
+    // to the same endpoint with SO_REUSEPORT. the kernel distributes
+    // incoming connections across them.
+    // falls back to a shared io_context if SO_REUSEPORT is not supported
+    // takes effect with the next call to listen
+    void sharded(bool sharded);
+    bool sharded() const;
+
+    // encode broadcast frames once and write them to all clients - default: false
+    // sendToAll then writes the frames past websocket::stream:
+    // one unfragmented frame per message, compressed once per window size
+    // for clients without context takeover. off, websocket::stream frames
+    // the message for every client.
+    // takes effect with the next call to listen
+    void preEncodedBroadcast(bool preEncoded);
+    bool preEncodedBroadcast() const;
+
+    // limits for the send queue of each client - default: unlimited
+    // takes effect with the next call to listen
+    void sendQueueLimits(const SendQueueLimits& limits);
+    SendQueueLimits sendQueueLimits() const;
+
+    // write queued messages of a client together - default: disabled
+    // trades latency for throughput with bursts of small messages
+    // takes effect with the next call to listen
+    void writeCoalescing(const WriteCoalescing& coalescing);
+    WriteCoalescing writeCoalescing() const;
+
+    // pass received messages to receivedOwned - default: false
+    // the message is moved out of the read buffer instead of being copied,
+    // the next message needs a new buffer
+    // takes effect with the next call to listen
+    void moveReceived(bool move);
+    bool moveReceived() const;
+
+    // pass received messages in chunks to receivedChunk - default: disabled
+    // large messages are processed while they arrive
+    // takes effect with the next call to listen
+    void streamingReceive(const StreamingReceive& options);
+    StreamingReceive streamingReceive() const;
+
+    // largest received message and memory kept by the read buffer
+    // - default: 16 MB, 64 KB
+    // takes effect with the next call to listen
+    void readLimits(const ReadLimits& limits);
+    ReadLimits readLimits() const;
+
+    // ping clients to measure the round trip time - default: disabled
+    // takes effect with the next call to listen
+    void ping(const PingOptions& options);
+    PingOptions ping() const;
+
+    // permessage-deflate - default: disabled
+    // takes effect with the next call to listen
+    void compression(const CompressionOptions& options);
+    CompressionOptions compression() const;
+
+    // serve wss:// - default: disabled
+    // takes effect with the next call to listen
+    void tls(const TlsOptions& options);
+    TlsOptions tls() const;
+
     void listen(uint16_t port, const std::string& address = "");
+    // listen on a unix domain socket, clients connect with ws+unix://
+    // tls and sharded do not apply
+    // not supported on windows, see ServerListener::localSupported
+    void listenLocal(const std::string& path);
+    std::string localPath() const;
     bool isListening() const;
     void close();
 
     size_t clientCount() const;
 
+    // counters of all clients since the server was created
+    // can be called from any thread
+    MetricsSnapshot metrics() const;
+    // counters of one client, returns false if it is not connected
+    bool metrics(ClientId client, MetricsSnapshot& snapshot) const;
+    // round trip time of one client, returns false if it is not connected
+    bool roundTripTime(ClientId client, RoundTripTime& rtt) const;
+
+    // sendTo returns NotConnected if the client is not connected
+    // mode overrides the compression threshold for this message
+
     // send text data
-    void sendToAll(const std::string& str, void* except = nullptr);
-    void sendTo(const std::string& str, void* client);
+    void sendToAll(const std::string& str, ClientId except = 0, CompressionMode mode = CompressionMode::Auto);
+    SendResult sendTo(const std::string& str, ClientId client, CompressionMode mode = CompressionMode::Auto);
 
     // send binary data
-    void sendToAll(const std::vector<char>& str, void* except = nullptr);
-    void sendTo(const std::vector<char>& data, void* client);
+    void sendToAll(const std::vector<char>& str, ClientId except = 0, CompressionMode mode = CompressionMode::Auto);
+    SendResult sendTo(const std::vector<char>& data, ClientId client, CompressionMode mode = CompressionMode::Auto);
+
+    // take over the storage without copying
+    void sendToAll(std::string&& str, ClientId except = 0, CompressionMode mode = CompressionMode::Auto);
+    SendResult sendTo(std::string&& str, ClientId client, CompressionMode mode = CompressionMode::Auto);
+    void sendToAll(std::vector<char>&& data, ClientId except = 0, CompressionMode mode = CompressionMode::Auto);
+    SendResult sendTo(std::vector<char>&& data, ClientId client, CompressionMode mode = CompressionMode::Auto);
+
+    // send a shared or borrowed payload without copying it
+    // the same buffer can be used for any number of calls
+    void sendToAll(const SharedBuffer& buffer, ClientId except = 0, CompressionMode mode = CompressionMode::Auto);
+    SendResult sendTo(const SharedBuffer& buffer, ClientId client, CompressionMode mode = CompressionMode::Auto);
+
+    // send a large message in fragments, one chunk of producer at a time
+    // the producer is used by one client, there is no broadcast
+    SendResult sendStreamTo(ChunkProducer producer, ClientId client, CompressionMode mode = CompressionMode::Auto);
 
 public:
     // IServerSessionListener
     virtual void listening() override;
     virtual void closed() override;
-    virtual void clientConnected(void* client) override;
-    virtual void clientDisconnected(void* client) override;
-    virtual void received(const char* data, size_t size, void* client) override;
-    virtual void received(const std::string& msg, void* client) override;
+    virtual void clientConnected(ClientId client) override;
+    virtual void clientDisconnected(ClientId client) override;
+    virtual void error(int code, const std::string& message) override;
+    virtual void received(const char* data, size_t size, ClientId client) override;
+    virtual void received(const std::string& msg, ClientId client) override;
 
 private:
     void run();
+    void runContext(net::io_context& ioc);
+    // reports a certificate or key which can not be loaded to error
+    std::shared_ptr<ssl::context> createSslContext();
+    std::vector<std::shared_ptr<ServerListener>> listeners() const;
 
 private:
     bool m_binary{true};
+    size_t m_threads{1};
+    bool m_sharded{false};
+    bool m_preEncodedBroadcast{false};
+    SendQueueLimits m_sendQueueLimits;
+    WriteCoalescing m_writeCoalescing;
+    bool m_moveReceived{false};
+    StreamingReceive m_streamingReceive;
+    ReadLimits m_readLimits;
+    PingOptions m_ping;
+    CompressionOptions m_compression;
+    TlsOptions m_tls;
 
     net::ip::address m_address;
     uint16_t m_port{0};
+    std::string m_localPath;
 
-    std::shared_ptr<ServerListener> m_listener;
+    std::vector<std::shared_ptr<ServerListener>> m_listeners;
+    // the counters of closed listeners
+    Metrics m_metrics;
 
     std::thread* m_thread{nullptr};
     mutable std::mutex m_mutex;
@@ -0,0 +1,63 @@
+/* Benchmarks of the websocket server and client using Boost.Beast
+ *
+ * (C) Copyright Ingo Randolf 2025.
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See
+ * accompanying file LICENSE or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ *
+ */
+
+#ifndef SCARYWS_BENCH_COMMON_H
+#define SCARYWS_BENCH_COMMON_H
+
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <thread>
+
+namespace scaryws
+{
+namespace bench
+{
+
+// the numeric argument at index, or fallback if it is not given
+inline size_t argument(int argc, char** argv, int index, size_t fallback)
+{
+    if (index < argc)
+    {
+        return static_cast<size_t>(std::strtoull(argv[index], nullptr, 10));
+    }
+
+    return fallback;
+}
+
+// poll done until it returns true
+// returns false after timeout
+inline bool waitUntil(std::function<bool()> done,
+                      std::chrono::milliseconds timeout = std::chrono::milliseconds(10000))
+{
+    const auto end = std::chrono::steady_clock::now() + timeout;
+
+    while (!done())
+    {
+        if (std::chrono::steady_clock::now() > end)
+        {
+            return false;
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    return true;
+}
+
+inline double secondsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace bench
+} // namespace scaryws
+
+#endif // SCARYWS_BENCH_COMMON_H
@@ -0,0 +1,292 @@
+/* Benchmarks of the websocket server and client using Boost.Beast
+ *
+ * (C) Copyright Ingo Randolf 2025.
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See
+ * accompanying file LICENSE or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ *
+ */
+
+// pre-encoded broadcast next to pings, closes and deflate sessions
+//
+// usage: broadcast_check [clients per kind] [messages] [pre-encoded 0/1] [port]
+//
+// the server broadcasts numbered messages of three sizes, every client
+// checks the content and order of what it receives:
+// plain: no compression
+// deflate: permessage-deflate without context takeover, 15 and 10 window bits
+// closing: plain and deflate clients which disconnect and connect again
+// server and clients ping every few milliseconds.
+// exits with 1 if a message is corrupt, out of order or missing.
+
+#include "BenchCommon.h"
+
+#include "ClientEventLoop.h"
+#include "WebsocketClient.h"
+#include "WebsocketServer.h"
+
+#include <atomic>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace scaryws;
+
+namespace
+{
+
+// below, around and above the compression threshold
+std::string message(uint64_t number)
+{
+    static const size_t sizes[] = { 16, 600, 20000 };
+
+    std::string payload = std::to_string(number) + ":";
+    const size_t size = sizes[number % 3];
+
+    while (payload.size() < size)
+    {
+        payload += "{\"sensor\":" + std::to_string(number % 97) + ",\"value\":\"ok\"}";
+    }
+
+    payload.resize(size);
+
+    return payload;
+}
+
+class CheckingClient
+    : public WebsocketClient
+{
+public:
+    void connected() override
+    {
+        // a new connection starts with the next broadcast
+        last = 0;
+    }
+
+    void received(const char* data, size_t size) override
+    {
+        check(std::string(data, size));
+    }
+
+    void received(const std::string& msg) override
+    {
+        check(msg);
+    }
+
+    void check(const std::string& payload)
+    {
+        const uint64_t number = std::strtoull(payload.c_str(), nullptr, 10);
+
+        if (payload != message(number))
+        {
+            corrupt.fetch_add(1, std::memory_order_relaxed);
+        }
+        else if (number <= last)
+        {
+            unordered.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        last = number;
+        messages.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // only used on the event loop
+    uint64_t last{0};
+
+    std::atomic<uint64_t> messages{0};
+    std::atomic<uint64_t> corrupt{0};
+    std::atomic<uint64_t> unordered{0};
+};
+
+struct Kind
+{
+    const char* name;
+    bool deflate;
+    int windowBits;
+    bool closing;
+};
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const size_t perKind = bench::argument(argc, argv, 1, 4);
+    const size_t messages = bench::argument(argc, argv, 2, 20000);
+    const bool preEncoded = bench::argument(argc, argv, 3, 1) != 0;
+    const uint16_t port = static_cast<uint16_t>(bench::argument(argc, argv, 4, 9500));
+
+    PingOptions ping;
+    ping.enabled = true;
+    ping.interval = std::chrono::milliseconds(5);
+
+    CompressionOptions compression;
+    compression.enabled = true;
+    compression.serverNoContextTakeover = true;
+
+    WebsocketServer server;
+    server.threads(2);
+    server.preEncodedBroadcast(preEncoded);
+    server.ping(ping);
+    server.compression(compression);
+    server.listen(port, "127.0.0.1");
+
+    if (!bench::waitUntil([&server] { return server.isListening(); }))
+    {
+        std::fprintf(stderr, "server does not listen\n");
+        return 1;
+    }
+
+    const std::string url = "ws://127.0.0.1:" + std::to_string(port) + "/";
+    auto loop = std::make_shared<ClientEventLoop>(2);
+
+    const std::vector<Kind> kinds =
+    {
+        { "plain", false, 15, false },
+        { "deflate15", true, 15, false },
+        { "deflate10", true, 10, false },
+        { "closing", false, 15, true },
+        { "closing-deflate", true, 15, true }
+    };
+
+    std::vector<std::unique_ptr<CheckingClient>> clients;
+
+    for (auto& kind : kinds)
+    {
+        for (size_t i = 0; i < perKind; i++)
+        {
+            CompressionOptions options;
+            options.enabled = kind.deflate;
+            options.serverMaxWindowBits = kind.windowBits;
+            options.serverNoContextTakeover = true;
+
+            std::unique_ptr<CheckingClient> client(new CheckingClient());
+            client->eventLoop(loop);
+            client->ping(ping);
+            client->compression(options);
+            client->connect(url);
+            clients.push_back(std::move(client));
+        }
+    }
+
+    if (!bench::waitUntil([&]
+    {
+        return server.clientCount() == clients.size();
+    }))
+    {
+        std::fprintf(stderr, "%zu of %zu clients connected\n", server.clientCount(), clients.size());
+        return 1;
+    }
+
+    // close and connect again while the server broadcasts
+    std::atomic<bool> sending{true};
+    std::vector<std::thread> closers;
+
+    for (size_t k = 0; k < kinds.size(); k++)
+    {
+        if (!kinds[k].closing)
+        {
+            continue;
+        }
+
+        for (size_t i = 0; i < perKind; i++)
+        {
+            CheckingClient* client = clients[k * perKind + i].get();
+
+            closers.emplace_back([client, &sending, &url]
+            {
+                while (sending.load())
+                {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+                    client->disconnect();
+                    client->connect(url);
+                }
+            });
+        }
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+
+    for (uint64_t number = 1; number <= messages; number++)
+    {
+        server.sendToAll(message(number));
+
+        // let pings and closes interleave with the broadcast
+        if (number % 64 == 0)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+    sending.store(false);
+
+    for (auto& closer : closers)
+    {
+        closer.join();
+    }
+
+    // the clients which stay connected get every message
+    bench::waitUntil([&]
+    {
+        for (size_t k = 0; k < kinds.size(); k++)
+        {
+            for (size_t i = 0; i < perKind && !kinds[k].closing; i++)
+            {
+                if (clients[k * perKind + i]->messages.load() < messages)
+                {
+                    return false;
+                }
+            }
+        }
+
+        return true;
+    }, std::chrono::milliseconds(60000));
+
+    const double seconds = bench::secondsSince(start);
+
+    std::printf("%zu messages, pre-encoded %s, %.1f s\n", messages, preEncoded ? "on" : "off", seconds);
+    std::printf("%-16s %12s %10s %10s %10s\n", "", "received", "corrupt", "unordered", "missing");
+
+    bool failed = false;
+
+    for (size_t k = 0; k < kinds.size(); k++)
+    {
+        uint64_t received = 0;
+        uint64_t corrupt = 0;
+        uint64_t unordered = 0;
+        uint64_t missing = 0;
+
+        for (size_t i = 0; i < perKind; i++)
+        {
+            const CheckingClient& client = *clients[k * perKind + i];
+
+            received += client.messages.load();
+            corrupt += client.corrupt.load();
+            unordered += client.unordered.load();
+
+            if (!kinds[k].closing &&
+                client.messages.load() < messages)
+            {
+                missing += messages - client.messages.load();
+            }
+        }
+
+        failed = failed || corrupt > 0 || unordered > 0 || missing > 0;
+
+        std::printf("%-16s %12llu %10llu %10llu %10llu\n",
+                    kinds[k].name,
+                    static_cast<unsigned long long>(received),
+                    static_cast<unsigned long long>(corrupt),
+                    static_cast<unsigned long long>(unordered),
+                    static_cast<unsigned long long>(missing));
+    }
+
+    clients.clear();
+    server.close();
+
+    std::printf("%s\n", failed ? "FAILED" : "ok");
+
+    return failed ? 1 : 0;
+}
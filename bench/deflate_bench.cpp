@@ -0,0 +1,150 @@
+/* Benchmarks of the websocket server and client using Boost.Beast
+ *
+ * (C) Copyright Ingo Randolf 2025.
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See
+ * accompanying file LICENSE or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ *
+ */
+
+// CPU cost of permessage-deflate against the bytes it saves
+//
+// usage: deflate_bench [milliseconds per case]
+//
+// every message is compressed on its own with deflateMessage, like a
+// session without context takeover or a pre-encoded broadcast does.
+
+#include "BenchCommon.h"
+
+#include "Compression.h"
+#include "SharedBuffer.h"
+
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace scaryws;
+
+namespace
+{
+
+// an array of records with repeated keys, like our JSON traffic
+std::string jsonPayload(size_t size, std::minstd_rand& random)
+{
+    std::string json = "[";
+
+    for (size_t i = 0; json.size() < size; i++)
+    {
+        json += i > 0 ? "," : "";
+        json += "{\"id\":" + std::to_string(i) +
+                ",\"name\":\"sensor-" + std::to_string(random() % 1000) +
+                "\",\"value\":" + std::to_string(random() % 100000) +
+                ",\"unit\":\"mV\",\"status\":\"" + (random() % 8 ? "ok" : "warning") + "\"}";
+    }
+
+    json += "]";
+
+    return json;
+}
+
+// data deflate can not compress
+std::string randomPayload(size_t size, std::minstd_rand& random)
+{
+    std::string data(size, '\0');
+
+    for (auto& c : data)
+    {
+        c = static_cast<char>(random());
+    }
+
+    return data;
+}
+
+struct Case
+{
+    const char* name;
+    SharedBuffer payload;
+};
+
+struct Settings
+{
+    int compressionLevel;
+    int memLevel;
+    int windowBits;
+};
+
+void run(const Case& payload, const Settings& settings, std::chrono::milliseconds duration)
+{
+    CompressionOptions options;
+    options.compressionLevel = settings.compressionLevel;
+    options.memLevel = settings.memLevel;
+
+    size_t messages = 0;
+    size_t compressed = 0;
+    const auto start = std::chrono::steady_clock::now();
+    const auto end = start + duration;
+
+    while (std::chrono::steady_clock::now() < end)
+    {
+        const SharedBuffer deflated = deflateMessage(payload.payload, settings.windowBits, options);
+
+        // not smaller, sent as it is
+        compressed += deflated.empty() ? payload.payload.size() : deflated.size();
+        messages++;
+    }
+
+    const double seconds = bench::secondsSince(start);
+    const double input = static_cast<double>(payload.payload.size()) * messages;
+
+    std::printf("%-12s %8zu %5d %4d %5d %8.1f%% %10.1f %10.2f\n",
+                payload.name,
+                payload.payload.size(),
+                settings.compressionLevel,
+                settings.memLevel,
+                settings.windowBits,
+                100.0 * (1.0 - static_cast<double>(compressed) / input),
+                input / seconds / (1024 * 1024),
+                seconds * 1e6 / messages);
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const std::chrono::milliseconds duration(bench::argument(argc, argv, 1, 500));
+
+    std::minstd_rand random(1);
+
+    const std::vector<Case> cases =
+    {
+        { "json", SharedBuffer(jsonPayload(256, random)) },
+        { "json", SharedBuffer(jsonPayload(4 * 1024, random)) },
+        { "json", SharedBuffer(jsonPayload(64 * 1024, random)) },
+        { "random", SharedBuffer(randomPayload(4 * 1024, random)) }
+    };
+
+    // the defaults of CompressionOptions first
+    const std::vector<Settings> settings =
+    {
+        { 8, 4, 15 },
+        { 1, 4, 15 },
+        { 6, 8, 15 },
+        { 9, 9, 15 },
+        { 8, 4, 10 }
+    };
+
+    std::printf("%-12s %8s %5s %4s %5s %9s %10s %10s\n",
+                "payload", "bytes", "level", "mem", "bits", "saved", "MB/s", "us/msg");
+
+    for (auto& payload : cases)
+    {
+        for (auto& setting : settings)
+        {
+            run(payload, setting, duration);
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,253 @@
+/* Benchmarks of the websocket server and client using Boost.Beast
+ *
+ * (C) Copyright Ingo Randolf 2025.
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See
+ * accompanying file LICENSE or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ *
+ */
+
+// memory of idle connections with and without ReadLimits::releaseIdle
+//
+// usage: idle_memory_bench [connections] [message size] [port]
+//
+// read buffers: the capacity the read buffers of idle sessions keep
+// after one message each.
+// connections: the resident memory a server grows by per connection.
+// the clients run in a child process, every client sends one message
+// and stays connected. both processes need a file limit above the
+// number of connections, e.g. ulimit -n 120000.
+
+#include "BenchCommon.h"
+
+#include "ClientEventLoop.h"
+#include "ReadBuffer.h"
+#include "WebsocketClient.h"
+#include "WebsocketServer.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace scaryws;
+
+namespace
+{
+
+class CountingServer
+    : public WebsocketServer
+{
+public:
+    void received(const char* data, size_t size, ClientId client) override
+    {
+        messages.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void received(const std::string& msg, ClientId client) override
+    {
+        messages.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    std::atomic<uint64_t> messages{0};
+};
+
+size_t residentBytes()
+{
+    long pages = 0;
+    long resident = 0;
+
+    FILE* file = std::fopen("/proc/self/statm", "r");
+
+    if (file)
+    {
+        if (std::fscanf(file, "%ld %ld", &pages, &resident) != 2)
+        {
+            resident = 0;
+        }
+
+        std::fclose(file);
+    }
+
+    return static_cast<size_t>(resident) * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+}
+
+// raise the file limit to the hard limit, returns the new limit
+size_t raiseFileLimit()
+{
+    struct rlimit limit;
+
+    if (getrlimit(RLIMIT_NOFILE, &limit) != 0)
+    {
+        return 0;
+    }
+
+    limit.rlim_cur = limit.rlim_max;
+
+    if (setrlimit(RLIMIT_NOFILE, &limit) != 0 &&
+        getrlimit(RLIMIT_NOFILE, &limit) != 0)
+    {
+        return 0;
+    }
+
+    return static_cast<size_t>(limit.rlim_cur);
+}
+
+// bytes per buffer kept by idle read buffers
+size_t readBuffers(size_t count, size_t messageSize, bool releaseIdle)
+{
+    ReadLimits limits;
+    limits.releaseIdle = releaseIdle;
+
+    std::vector<ReadBuffer> buffers(count);
+    size_t capacity = 0;
+
+    for (auto& buffer : buffers)
+    {
+        buffer.limits(limits);
+
+        auto data = buffer.prepare(messageSize);
+        std::memset(data.data(), 'x', messageSize);
+        buffer.commit(messageSize);
+        buffer.finish();
+
+        capacity += buffer.capacity();
+    }
+
+    return capacity / count;
+}
+
+// the client process: connect, send one message each, wait for the parent
+void runClients(int start, int stop, size_t connections, size_t messageSize, uint16_t port)
+{
+    char signal = 0;
+
+    if (read(start, &signal, 1) != 1)
+    {
+        return;
+    }
+
+    auto loop = std::make_shared<ClientEventLoop>(2);
+    const SharedBuffer payload(std::string(messageSize, 'x'));
+
+    std::vector<std::unique_ptr<WebsocketClient>> clients;
+
+    for (size_t i = 0; i < connections; i++)
+    {
+        std::unique_ptr<WebsocketClient> client(new WebsocketClient());
+        client->eventLoop(loop);
+        client->connect("ws://127.0.0.1:" + std::to_string(port) + "/");
+        clients.push_back(std::move(client));
+    }
+
+    for (auto& client : clients)
+    {
+        // queued until the connection is open
+        client->send(payload);
+    }
+
+    // until the parent measured
+    if (read(stop, &signal, 1) < 0)
+    {
+        return;
+    }
+}
+
+// resident bytes per connection of the server
+double connections(size_t count, size_t messageSize, uint16_t port, bool releaseIdle)
+{
+    int start[2];
+    int stop[2];
+
+    if (pipe(start) != 0 ||
+        pipe(stop) != 0)
+    {
+        return 0;
+    }
+
+    // fork before any thread is started
+    const pid_t child = fork();
+
+    if (child == 0)
+    {
+        close(start[1]);
+        close(stop[1]);
+        runClients(start[0], stop[0], count, messageSize, port);
+        _exit(0);
+    }
+
+    close(start[0]);
+    close(stop[0]);
+
+    ReadLimits limits;
+    limits.releaseIdle = releaseIdle;
+
+    CountingServer server;
+    server.readLimits(limits);
+    server.listen(port, "127.0.0.1");
+    bench::waitUntil([&server] { return server.isListening(); });
+
+    const size_t before = residentBytes();
+
+    const char signal = 1;
+    double perConnection = 0;
+
+    if (write(start[1], &signal, 1) == 1 &&
+        bench::waitUntil([&] { return server.messages.load() >= count; }, std::chrono::milliseconds(120000)))
+    {
+        perConnection = static_cast<double>(residentBytes() - before) / count;
+    }
+    else
+    {
+        std::fprintf(stderr, "%zu of %zu messages received, raise the file limit?\n",
+                     static_cast<size_t>(server.messages.load()), count);
+    }
+
+    // the clients exit
+    close(start[1]);
+    close(stop[1]);
+    waitpid(child, nullptr, 0);
+
+    server.close();
+
+    return perConnection;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const size_t count = bench::argument(argc, argv, 1, 50000);
+    const size_t messageSize = bench::argument(argc, argv, 2, 16 * 1024);
+    const uint16_t port = static_cast<uint16_t>(bench::argument(argc, argv, 3, 9400));
+
+    // every connection is a file in both processes, plus a few more
+    const size_t files = raiseFileLimit();
+
+    if (files < count + 64)
+    {
+        std::fprintf(stderr, "the file limit %zu is too low for %zu connections\n", files, count);
+        return 1;
+    }
+
+    std::printf("%zu connections, one message of %zu bytes each\n", count, messageSize);
+    std::printf("%-14s %16s %16s\n", "", "bytes/idle", "releaseIdle");
+
+    std::printf("%-14s %16zu %16zu\n", "read buffers",
+                readBuffers(count, messageSize, false),
+                readBuffers(count, messageSize, true));
+
+    const double kept = connections(count, messageSize, port, false);
+    const double released = connections(count, messageSize, static_cast<uint16_t>(port + 1), true);
+
+    std::printf("%-14s %16.0f %16.0f\n", "connections", kept, released);
+
+    return 0;
+}
@@ -0,0 +1,216 @@
+/* Benchmarks of the websocket server and client using Boost.Beast
+ *
+ * (C) Copyright Ingo Randolf 2025.
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See
+ * accompanying file LICENSE or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ *
+ */
+
+// the lock-free SendQueue against the vector and mutex it replaced
+//
+// usage: queue_bench [max producers] [messages per producer] [queue depth]
+//
+// contention: producers push from their own threads while one consumer
+// drains the queue like a session does: front, pop.
+// deep queue: a queue of the given depth is drained by the consumer.
+
+#include "BenchCommon.h"
+
+#include "SendQueue.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace scaryws;
+
+namespace
+{
+
+// the send queue before the lock-free one
+class MutexQueue
+{
+public:
+    void push(const std::shared_ptr<std::vector<char>>& message)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_queue.push_back(message);
+    }
+
+    bool front(std::shared_ptr<std::vector<char>>& message)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        if (m_queue.empty())
+        {
+            return false;
+        }
+
+        message = m_queue.front();
+        return true;
+    }
+
+    void pop()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_queue.erase(m_queue.begin());
+    }
+
+private:
+    std::mutex m_mutex;
+    std::vector<std::shared_ptr<std::vector<char>>> m_queue;
+};
+
+struct MutexBench
+{
+    MutexQueue queue;
+    std::shared_ptr<std::vector<char>> payload{std::make_shared<std::vector<char>>(64, 'x')};
+
+    void push()
+    {
+        queue.push(payload);
+    }
+
+    bool consume()
+    {
+        std::shared_ptr<std::vector<char>> message;
+
+        if (!queue.front(message))
+        {
+            return false;
+        }
+
+        queue.pop();
+        return true;
+    }
+};
+
+struct LockFreeBench
+{
+    SendQueue queue;
+    SharedBuffer payload{std::string(64, 'x')};
+
+    void push()
+    {
+        OutgoingMessage message;
+        message.payload = payload;
+        message.compression = CompressionMode::Auto;
+
+        bool start = false;
+        queue.push(std::move(message), start);
+    }
+
+    bool consume()
+    {
+        OutgoingMessage message;
+
+        if (!queue.front(message))
+        {
+            return false;
+        }
+
+        queue.pop();
+        return true;
+    }
+};
+
+// messages per second through the queue with concurrent producers
+template<class Bench>
+double contention(size_t producers, size_t messages)
+{
+    Bench queue;
+    std::atomic<bool> go{false};
+    std::vector<std::thread> threads;
+
+    for (size_t p = 0; p < producers; p++)
+    {
+        threads.emplace_back([&]
+        {
+            while (!go.load(std::memory_order_acquire))
+            {
+            }
+
+            for (size_t i = 0; i < messages; i++)
+            {
+                queue.push();
+            }
+        });
+    }
+
+    const size_t total = producers * messages;
+    const auto start = std::chrono::steady_clock::now();
+    go.store(true, std::memory_order_release);
+
+    for (size_t consumed = 0; consumed < total; )
+    {
+        if (queue.consume())
+        {
+            consumed++;
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    const double elapsed = bench::secondsSince(start);
+
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    return static_cast<double>(total) / elapsed;
+}
+
+// messages per second draining a queue of depth messages
+template<class Bench>
+double drain(size_t depth)
+{
+    Bench queue;
+
+    for (size_t i = 0; i < depth; i++)
+    {
+        queue.push();
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+
+    while (queue.consume())
+    {
+    }
+
+    return static_cast<double>(depth) / bench::secondsSince(start);
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const size_t maxProducers = bench::argument(argc, argv, 1, std::max<unsigned>(std::thread::hardware_concurrency(), 2));
+    const size_t messages = bench::argument(argc, argv, 2, 50000);
+    const size_t depth = bench::argument(argc, argv, 3, 50000);
+
+    std::printf("contention, %zu messages per producer\n", messages);
+    std::printf("%10s %16s %16s\n", "producers", "mutex msg/s", "lock-free msg/s");
+
+    for (size_t producers = 1; producers <= maxProducers; producers *= 2)
+    {
+        std::printf("%10zu %16.0f %16.0f\n",
+                    producers,
+                    contention<MutexBench>(producers, messages),
+                    contention<LockFreeBench>(producers, messages));
+    }
+
+    std::printf("\ndrain a queue of %zu messages\n", depth);
+    std::printf("%16s %16s\n", "mutex msg/s", "lock-free msg/s");
+    std::printf("%16.0f %16.0f\n", drain<MutexBench>(depth), drain<LockFreeBench>(depth));
+
+    return 0;
+}
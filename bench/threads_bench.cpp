@@ -0,0 +1,180 @@
+/* Benchmarks of the websocket server and client using Boost.Beast
+ *
+ * (C) Copyright Ingo Randolf 2025.
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See
+ * accompanying file LICENSE or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ *
+ */
+
+// messages per second received by a server running 1 to N io threads
+//
+// usage: threads_bench [max threads] [clients] [seconds] [message size] [port]
+//
+// the clients run in the same process on their own event loop,
+// on a machine with few cores they compete with the server threads.
+
+#include "BenchCommon.h"
+
+#include "ClientEventLoop.h"
+#include "WebsocketClient.h"
+#include "WebsocketServer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace scaryws;
+
+namespace
+{
+
+class CountingServer
+    : public WebsocketServer
+{
+public:
+    void received(const char* data, size_t size, ClientId client) override
+    {
+        messages.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void received(const std::string& msg, ClientId client) override
+    {
+        messages.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    std::atomic<uint64_t> messages{0};
+};
+
+// messages per second with threads io threads
+double measure(size_t threads,
+               size_t clientCount,
+               size_t seconds,
+               size_t messageSize,
+               uint16_t port)
+{
+    CountingServer server;
+    server.threads(threads);
+    server.listen(port, "127.0.0.1");
+
+    if (!bench::waitUntil([&server] { return server.isListening(); }))
+    {
+        std::fprintf(stderr, "server does not listen on port %u\n", port);
+        return 0;
+    }
+
+    // the clients get half of the cores
+    const size_t cores = std::max<unsigned>(std::thread::hardware_concurrency(), 2);
+    auto loop = std::make_shared<ClientEventLoop>(cores / 2);
+
+    // a bounded queue keeps the senders from running ahead of the writes
+    SendQueueLimits limits;
+    limits.maxMessages = 256;
+    limits.policy = OverflowPolicy::Reject;
+
+    std::vector<std::unique_ptr<WebsocketClient>> clients;
+
+    for (size_t i = 0; i < clientCount; i++)
+    {
+        std::unique_ptr<WebsocketClient> client(new WebsocketClient());
+        client->eventLoop(loop);
+        client->sendQueueLimits(limits);
+        client->connect("ws://127.0.0.1:" + std::to_string(port) + "/");
+        clients.push_back(std::move(client));
+    }
+
+    const bool connected = bench::waitUntil([&clients]
+    {
+        return std::all_of(clients.begin(), clients.end(), [](const std::unique_ptr<WebsocketClient>& client)
+        {
+            return client->isConnected();
+        });
+    });
+
+    if (!connected)
+    {
+        std::fprintf(stderr, "not all clients connected\n");
+        return 0;
+    }
+
+    // one payload for all sends
+    const SharedBuffer payload(std::string(messageSize, 'x'));
+
+    std::atomic<bool> running{true};
+    std::vector<std::thread> senders;
+    const size_t senderCount = std::max<size_t>(cores / 4, 1);
+
+    for (size_t s = 0; s < senderCount; s++)
+    {
+        senders.emplace_back([&, s]
+        {
+            while (running.load(std::memory_order_relaxed))
+            {
+                for (size_t i = s; i < clients.size(); i += senderCount)
+                {
+                    clients[i]->send(payload);
+                }
+            }
+        });
+    }
+
+    // skip the ramp up
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+
+    const uint64_t before = server.messages.load();
+    const auto start = std::chrono::steady_clock::now();
+
+    std::this_thread::sleep_for(std::chrono::seconds(seconds));
+
+    const uint64_t received = server.messages.load() - before;
+    const double elapsed = bench::secondsSince(start);
+
+    running = false;
+
+    for (auto& sender : senders)
+    {
+        sender.join();
+    }
+
+    clients.clear();
+    server.close();
+
+    return static_cast<double>(received) / elapsed;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const size_t maxThreads = bench::argument(argc, argv, 1, std::max<unsigned>(std::thread::hardware_concurrency(), 1));
+    const size_t clients = bench::argument(argc, argv, 2, 64);
+    const size_t seconds = bench::argument(argc, argv, 3, 3);
+    const size_t messageSize = bench::argument(argc, argv, 4, 128);
+    const uint16_t port = static_cast<uint16_t>(bench::argument(argc, argv, 5, 9100));
+
+    std::printf("clients: %zu, message: %zu bytes, %zu s per run\n", clients, messageSize, seconds);
+    std::printf("%8s %14s %8s\n", "threads", "messages/s", "scaling");
+
+    double single = 0;
+    size_t run = 0;
+
+    for (size_t threads = 1; threads <= maxThreads; threads = threads < maxThreads ? std::min(threads * 2, maxThreads) : threads + 1)
+    {
+        // a new port for every run, the last one may still be in TIME_WAIT
+        const double rate = measure(threads, clients, seconds, messageSize, static_cast<uint16_t>(port + run++));
+
+        if (threads == 1)
+        {
+            single = rate;
+        }
+
+        std::printf("%8zu %14.0f %7.2fx\n", threads, rate, single > 0 ? rate / single : 0.0);
+    }
+
+    return 0;
+}
@@ -0,0 +1,238 @@
+/* Benchmarks of the websocket server and client using Boost.Beast
+ *
+ * (C) Copyright Ingo Randolf 2025.
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See
+ * accompanying file LICENSE or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ *
+ */
+
+// handshake rate and throughput of wss:// against ws://
+//
+// usage: tls_bench [handshakes] [messages] [message size] [port]
+//
+// the server uses a self-signed certificate generated at start,
+// the client does not verify it. the clients share the process-wide
+// TLS context, handshakes after the first one resume its session.
+
+#include "BenchCommon.h"
+
+#include "ClientEventLoop.h"
+#include "WebsocketClient.h"
+#include "WebsocketServer.h"
+
+#include <atomic>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include <openssl/ec.h>
+#include <openssl/evp.h>
+#include <openssl/obj_mac.h>
+#include <openssl/pem.h>
+#include <openssl/x509.h>
+
+using namespace scaryws;
+
+namespace
+{
+
+class CountingServer
+    : public WebsocketServer
+{
+public:
+    void received(const char* data, size_t size, ClientId client) override
+    {
+        messages.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void received(const std::string& msg, ClientId client) override
+    {
+        messages.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    std::atomic<uint64_t> messages{0};
+};
+
+// write a self-signed certificate for localhost and its key
+bool createCertificate(const std::string& certificateFile, const std::string& keyFile)
+{
+    EVP_PKEY* key = nullptr;
+    EVP_PKEY_CTX* keyContext = EVP_PKEY_CTX_new_id(EVP_PKEY_EC, nullptr);
+
+    if (!keyContext ||
+        EVP_PKEY_keygen_init(keyContext) <= 0 ||
+        EVP_PKEY_CTX_set_ec_paramgen_curve_nid(keyContext, NID_X9_62_prime256v1) <= 0 ||
+        EVP_PKEY_keygen(keyContext, &key) <= 0)
+    {
+        EVP_PKEY_CTX_free(keyContext);
+        return false;
+    }
+
+    EVP_PKEY_CTX_free(keyContext);
+
+    X509* certificate = X509_new();
+    X509_set_version(certificate, 2);
+    ASN1_INTEGER_set(X509_get_serialNumber(certificate), 1);
+    X509_gmtime_adj(X509_getm_notBefore(certificate), 0);
+    X509_gmtime_adj(X509_getm_notAfter(certificate), 24 * 60 * 60);
+    X509_set_pubkey(certificate, key);
+
+    X509_NAME* name = X509_get_subject_name(certificate);
+    X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC,
+                               reinterpret_cast<const unsigned char*>("localhost"), -1, -1, 0);
+    X509_set_issuer_name(certificate, name);
+
+    bool written = X509_sign(certificate, key, EVP_sha256()) > 0;
+
+    FILE* file = std::fopen(certificateFile.c_str(), "w");
+    written = written && file && PEM_write_X509(file, certificate) == 1;
+
+    if (file)
+    {
+        std::fclose(file);
+    }
+
+    file = std::fopen(keyFile.c_str(), "w");
+    written = written && file && PEM_write_PrivateKey(file, key, nullptr, nullptr, 0, nullptr, nullptr) == 1;
+
+    if (file)
+    {
+        std::fclose(file);
+    }
+
+    X509_free(certificate);
+    EVP_PKEY_free(key);
+
+    return written;
+}
+
+// connections per second, one after the other
+double handshakes(const std::string& url, size_t count, const std::shared_ptr<ClientEventLoop>& loop)
+{
+    const auto start = std::chrono::steady_clock::now();
+
+    for (size_t i = 0; i < count; i++)
+    {
+        // the destructor waits until the connection is closed
+        WebsocketClient client;
+        client.verifyPeer(false);
+        client.eventLoop(loop);
+        client.connect(url);
+
+        if (!bench::waitUntil([&client] { return client.isConnected(); }))
+        {
+            std::fprintf(stderr, "%s: no connection\n", url.c_str());
+            return 0;
+        }
+    }
+
+    return static_cast<double>(count) / bench::secondsSince(start);
+}
+
+// MB per second from one client to the server
+double throughput(CountingServer& server,
+                  const std::string& url,
+                  size_t messages,
+                  size_t messageSize,
+                  const std::shared_ptr<ClientEventLoop>& loop)
+{
+    SendQueueLimits limits;
+    limits.maxMessages = 1024;
+    limits.policy = OverflowPolicy::Reject;
+
+    WebsocketClient client;
+    client.verifyPeer(false);
+    client.eventLoop(loop);
+    client.sendQueueLimits(limits);
+    client.connect(url);
+
+    if (!bench::waitUntil([&client] { return client.isConnected(); }))
+    {
+        std::fprintf(stderr, "%s: no connection\n", url.c_str());
+        return 0;
+    }
+
+    const SharedBuffer payload(std::string(messageSize, 'x'));
+    const uint64_t before = server.messages.load();
+    const auto start = std::chrono::steady_clock::now();
+
+    for (size_t i = 0; i < messages; i++)
+    {
+        while (client.send(payload) == SendResult::Rejected)
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    bench::waitUntil([&]
+    {
+        return server.messages.load() - before >= messages;
+    }, std::chrono::milliseconds(60000));
+
+    const double seconds = bench::secondsSince(start);
+
+    return static_cast<double>(messages) * messageSize / seconds / (1024 * 1024);
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const size_t handshakeCount = bench::argument(argc, argv, 1, 500);
+    const size_t messages = bench::argument(argc, argv, 2, 100000);
+    const size_t messageSize = bench::argument(argc, argv, 3, 1024);
+    const uint16_t port = static_cast<uint16_t>(bench::argument(argc, argv, 4, 9200));
+
+    const std::string certificateFile = "tls_bench_certificate.pem";
+    const std::string keyFile = "tls_bench_key.pem";
+
+    if (!createCertificate(certificateFile, keyFile))
+    {
+        std::fprintf(stderr, "can not create the certificate\n");
+        return 1;
+    }
+
+    CountingServer plain;
+    plain.listen(port, "127.0.0.1");
+
+    TlsOptions tls;
+    tls.enabled = true;
+    tls.certificateChainFile = certificateFile;
+    tls.privateKeyFile = keyFile;
+
+    CountingServer secure;
+    secure.tls(tls);
+    secure.listen(static_cast<uint16_t>(port + 1), "127.0.0.1");
+
+    if (!bench::waitUntil([&] { return plain.isListening() && secure.isListening(); }))
+    {
+        std::fprintf(stderr, "servers do not listen\n");
+        return 1;
+    }
+
+    const std::string ws = "ws://127.0.0.1:" + std::to_string(port) + "/";
+    const std::string wss = "wss://127.0.0.1:" + std::to_string(port + 1) + "/";
+
+    auto loop = std::make_shared<ClientEventLoop>(1);
+
+    const double wsHandshakes = handshakes(ws, handshakeCount, loop);
+    const double wsThroughput = throughput(plain, ws, messages, messageSize, loop);
+    const double wssHandshakes = handshakes(wss, handshakeCount, loop);
+    const double wssThroughput = throughput(secure, wss, messages, messageSize, loop);
+
+    std::printf("%-6s %14s %12s\n", "", "handshakes/s", "MB/s");
+    std::printf("%-6s %14.0f %12.1f\n", "ws", wsHandshakes, wsThroughput);
+    std::printf("%-6s %14.0f %12.1f\n", "wss", wssHandshakes, wssThroughput);
+    std::printf("%zu handshakes, %zu messages of %zu bytes\n", handshakeCount, messages, messageSize);
+
+    plain.close();
+    secure.close();
+
+    std::remove(certificateFile.c_str());
+    std::remove(keyFile.c_str());
+
+    return 0;
+}
@@ -0,0 +1,149 @@
+/* Benchmarks of the websocket server and client using Boost.Beast
+ *
+ * (C) Copyright Ingo Randolf 2025.
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See
+ * accompanying file LICENSE or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ *
+ */
+
+// round trip latency over a unix domain socket against loopback tcp
+//
+// usage: unix_bench [round trips] [message size] [port] [socket path]
+//
+// the client sends a message and waits for the server to echo it
+// before it sends the next one.
+
+#include "BenchCommon.h"
+
+#include "ClientEventLoop.h"
+#include "Histogram.h"
+#include "WebsocketClient.h"
+#include "WebsocketServer.h"
+
+#include <atomic>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace scaryws;
+
+namespace
+{
+
+class EchoServer
+    : public WebsocketServer
+{
+public:
+    void received(const char* data, size_t size, ClientId client) override
+    {
+        sendTo(std::vector<char>(data, data + size), client);
+    }
+
+    void received(const std::string& msg, ClientId client) override
+    {
+        sendTo(msg, client);
+    }
+};
+
+class EchoClient
+    : public WebsocketClient
+{
+public:
+    void received(const char* data, size_t size) override
+    {
+        echoes.fetch_add(1, std::memory_order_release);
+    }
+
+    void received(const std::string& msg) override
+    {
+        echoes.fetch_add(1, std::memory_order_release);
+    }
+
+    std::atomic<uint64_t> echoes{0};
+};
+
+void measure(const char* name, const std::string& url, size_t roundTrips, size_t messageSize)
+{
+    auto loop = std::make_shared<ClientEventLoop>(1);
+
+    EchoClient client;
+    client.eventLoop(loop);
+    client.connect(url);
+
+    if (!bench::waitUntil([&client] { return client.isConnected(); }))
+    {
+        std::fprintf(stderr, "%s: no connection\n", url.c_str());
+        return;
+    }
+
+    const SharedBuffer payload(std::string(messageSize, 'x'));
+    LatencyHistogram histogram;
+
+    // the first round trips are not measured
+    const size_t warmup = roundTrips / 10;
+
+    for (size_t i = 0; i < warmup + roundTrips; i++)
+    {
+        const uint64_t echoes = client.echoes.load(std::memory_order_acquire);
+        const auto start = std::chrono::steady_clock::now();
+
+        client.send(payload);
+
+        while (client.echoes.load(std::memory_order_acquire) == echoes)
+        {
+            std::this_thread::yield();
+        }
+
+        if (i >= warmup)
+        {
+            histogram.record(std::chrono::duration_cast<std::chrono::microseconds>(
+                                 std::chrono::steady_clock::now() - start));
+        }
+    }
+
+    const LatencySnapshot snapshot = histogram.snapshot();
+
+    std::printf("%-6s %10lld %10lld %10lld %10lld\n",
+                name,
+                static_cast<long long>(snapshot.percentile(0.5).count()),
+                static_cast<long long>(snapshot.percentile(0.9).count()),
+                static_cast<long long>(snapshot.percentile(0.99).count()),
+                static_cast<long long>(snapshot.percentile(0.999).count()));
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const size_t roundTrips = bench::argument(argc, argv, 1, 20000);
+    const size_t messageSize = bench::argument(argc, argv, 2, 256);
+    const uint16_t port = static_cast<uint16_t>(bench::argument(argc, argv, 3, 9300));
+    const std::string path = argc > 4 ? argv[4] : "/tmp/scaryws_unix_bench.sock";
+
+    EchoServer tcpServer;
+    tcpServer.listen(port, "127.0.0.1");
+
+    EchoServer unixServer;
+    unixServer.listenLocal(path);
+
+    if (!bench::waitUntil([&] { return tcpServer.isListening() && unixServer.isListening(); }))
+    {
+        std::fprintf(stderr, "servers do not listen\n");
+        return 1;
+    }
+
+    std::printf("%zu round trips of %zu bytes, microseconds\n", roundTrips, messageSize);
+    std::printf("%-6s %10s %10s %10s %10s\n", "", "p50", "p90", "p99", "p99.9");
+
+    measure("tcp", "ws://127.0.0.1:" + std::to_string(port) + "/", roundTrips, messageSize);
+    measure("unix", "ws+unix://" + path + ":/", roundTrips, messageSize);
+
+    tcpServer.close();
+    unixServer.close();
+
+    return 0;
+}